@@ -0,0 +1,238 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <tbb/parallel_for.h>
+
+#include "dijkstra.hpp"
+#include "dimacs.hpp"
+#include "graph.hpp"
+#include "graph_cache.hpp"
+#include "mapped_file.hpp"
+
+// ALT (A*, landmarks, triangle inequality) preprocessing. For each landmark L
+// we store d(L, v) and d(v, L) for every node, node-major so one heuristic
+// evaluation touches two contiguous rows. Distances are kept as 32-bit values;
+// ALT_INF marks unreachable pairs and pairs too long to represent, and such
+// terms are skipped, which keeps the bound admissible.
+inline constexpr std::uint32_t ALT_INF = 0xffffffffu;
+
+struct AltFileHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t n_landmarks;
+    std::uint64_t n_nodes;
+    std::uint64_t n_arcs;
+    std::uint64_t source_size;
+    std::int64_t source_mtime;
+    std::uint64_t landmarks_pos;
+    std::uint64_t from_pos;
+    std::uint64_t to_pos;
+};
+
+inline constexpr char ALT_FILE_MAGIC[8] = {'D', 'J', 'K', 'A', 'L', 'T', '\0', '\0'};
+inline constexpr std::uint32_t ALT_FILE_VERSION = 1;
+
+// Landmarks are drawn from the nodes with outgoing arcs, so a request for k
+// of them yields at most that many.
+inline int landmark_count(const CsrGraph &graph, int k)
+{
+    int candidates = 0;
+    for (int v = 1; v <= graph.num_nodes() && candidates < k; ++v)
+        candidates += graph.degree(v) > 0;
+    return candidates;
+}
+
+class AltTables
+{
+public:
+    AltTables() = default;
+
+    int num_landmarks() const { return (int)landmarks_.size(); }
+    std::span<const int> landmarks() const { return landmarks_; }
+
+    // d(L_i, v) and d(v, L_i) for i in [0, num_landmarks()).
+    std::span<const std::uint32_t> from(int v) const { return from_.subspan((std::size_t)v * landmarks_.size(), landmarks_.size()); }
+    std::span<const std::uint32_t> to(int v) const { return to_.subspan((std::size_t)v * landmarks_.size(), landmarks_.size()); }
+
+    // Lower bound on d(v, target) from the triangle inequality.
+    long long bound(int v, int target) const
+    {
+        auto from_v = from(v), from_t = from(target);
+        auto to_v = to(v), to_t = to(target);
+        long long best = 0;
+        for (std::size_t i = 0; i < landmarks_.size(); ++i)
+        {
+            // d(v, t) >= d(L, t) - d(L, v)
+            if (from_v[i] != ALT_INF && from_t[i] != ALT_INF)
+                best = std::max(best, (long long)from_t[i] - from_v[i]);
+            // d(v, t) >= d(v, L) - d(t, L)
+            if (to_v[i] != ALT_INF && to_t[i] != ALT_INF)
+                best = std::max(best, (long long)to_v[i] - to_t[i]);
+        }
+        return best;
+    }
+
+    // Runs one forward and one backward search per landmark on the TBB pool.
+    static AltTables build(const CsrGraph &graph, const CsrGraph &reverse, std::vector<int> landmarks)
+    {
+        AltTables tables;
+        const std::size_t n = graph.num_nodes();
+        const std::size_t k = landmarks.size();
+        auto owned = std::make_shared<std::array<std::vector<std::uint32_t>, 2>>();
+        auto &from = (*owned)[0];
+        auto &to = (*owned)[1];
+        from.assign((n + 1) * k, ALT_INF);
+        to.assign((n + 1) * k, ALT_INF);
+
+        tbb::parallel_for(std::size_t(0), 2 * k, [&](std::size_t job)
+                          {
+            std::size_t i = job % k;
+            bool backward = job >= k;
+            auto result = dijkstra_sequential(backward ? reverse : graph, landmarks[i]);
+            auto &table = backward ? to : from;
+            for (std::size_t v = 1; v <= n; ++v)
+                if (result.dist[v] < (long long)ALT_INF)
+                    table[v * k + i] = (std::uint32_t)result.dist[v]; });
+
+        tables.landmarks_ = std::move(landmarks);
+        tables.from_ = from;
+        tables.to_ = to;
+        tables.storage_ = std::move(owned);
+        return tables;
+    }
+
+    bool write(const std::string &path, const CsrGraph &graph, const SourceStamp &stamp) const
+    {
+        AltFileHeader header{};
+        std::memcpy(header.magic, ALT_FILE_MAGIC, sizeof header.magic);
+        header.version = ALT_FILE_VERSION;
+        header.n_landmarks = landmarks_.size();
+        header.n_nodes = graph.num_nodes();
+        header.n_arcs = graph.num_edges();
+        header.source_size = stamp.size;
+        header.source_mtime = stamp.mtime;
+        header.landmarks_pos = align_up(sizeof header, 64);
+        header.from_pos = align_up(header.landmarks_pos + landmarks_.size() * sizeof(int), 64);
+        header.to_pos = align_up(header.from_pos + from_.size_bytes(), 64);
+
+        return write_file_sections(path, {{0, &header, sizeof header},
+                                          {header.landmarks_pos, landmarks_.data(), landmarks_.size() * sizeof(int)},
+                                          {header.from_pos, from_.data(), from_.size_bytes()},
+                                          {header.to_pos, to_.data(), to_.size_bytes()}});
+    }
+
+    // Maps a landmark file. It is rejected unless it was built for a graph of
+    // the same shape from the same source file with n_landmarks landmarks,
+    // clamped as by landmark_count (0 accepts any count).
+    static bool map(const std::string &path, const CsrGraph &graph, const SourceStamp &stamp, int n_landmarks,
+                    AltTables &tables)
+    {
+        auto file = map_file(path);
+        if (!file || file->size() < sizeof(AltFileHeader))
+            return false;
+
+        AltFileHeader header;
+        std::memcpy(&header, file->data(), sizeof header);
+        if (std::memcmp(header.magic, ALT_FILE_MAGIC, sizeof header.magic) != 0 ||
+            header.version != ALT_FILE_VERSION)
+            return false;
+        if (header.n_nodes != (std::uint64_t)graph.num_nodes() || header.n_arcs != graph.num_edges() ||
+            header.source_size != stamp.size || header.source_mtime != stamp.mtime ||
+            (n_landmarks > 0 && header.n_landmarks != (std::uint32_t)landmark_count(graph, n_landmarks)))
+            return false;
+
+        std::uint64_t table_size = (header.n_nodes + 1) * header.n_landmarks;
+        if (header.landmarks_pos + header.n_landmarks * sizeof(int) > file->size() ||
+            header.from_pos % 64 || header.to_pos % 64 ||
+            header.from_pos + table_size * sizeof(std::uint32_t) > file->size() ||
+            header.to_pos + table_size * sizeof(std::uint32_t) > file->size())
+            return false;
+
+        auto landmarks = (const int *)(file->data() + header.landmarks_pos);
+        tables.landmarks_.assign(landmarks, landmarks + header.n_landmarks);
+        tables.from_ = std::span((const std::uint32_t *)(file->data() + header.from_pos), table_size);
+        tables.to_ = std::span((const std::uint32_t *)(file->data() + header.to_pos), table_size);
+        tables.storage_ = std::move(file);
+        return true;
+    }
+
+private:
+    std::vector<int> landmarks_;
+    std::span<const std::uint32_t> from_;
+    std::span<const std::uint32_t> to_;
+    std::shared_ptr<const void> storage_;
+};
+
+inline std::string alt_file_path(const std::string &filename)
+{
+    return filename + ".alt";
+}
+
+// Picks k landmarks spread over the graph. With coordinates, the plane around
+// the centroid is cut into k equal angular sectors and the node farthest from
+// the centroid in each sector is taken, which puts landmarks on the boundary
+// where they give the strongest bounds. Without coordinates, k nodes with
+// outgoing arcs are drawn with a fixed seed so runs are reproducible.
+inline std::vector<int> select_landmarks(const CsrGraph &graph, int k, const std::vector<Coord> *coords = nullptr)
+{
+    const int n = graph.num_nodes();
+    std::vector<int> candidates;
+    for (int v = 1; v <= n; ++v)
+        if (graph.degree(v) > 0)
+            candidates.push_back(v);
+    k = std::clamp<int>(k, 0, candidates.size());
+
+    std::vector<int> landmarks;
+    if (coords && !candidates.empty())
+    {
+        double cx = 0, cy = 0;
+        for (int v : candidates)
+        {
+            cx += (*coords)[v].x;
+            cy += (*coords)[v].y;
+        }
+        cx /= candidates.size();
+        cy /= candidates.size();
+
+        std::vector<int> best(k, -1);
+        std::vector<double> best_r2(k, -1.0);
+        for (int v : candidates)
+        {
+            double dx = (*coords)[v].x - cx, dy = (*coords)[v].y - cy;
+            double angle = std::atan2(dy, dx) + M_PI;
+            int sector = std::min(k - 1, (int)(angle / (2 * M_PI) * k));
+            double r2 = dx * dx + dy * dy;
+            if (r2 > best_r2[sector])
+            {
+                best_r2[sector] = r2;
+                best[sector] = v;
+            }
+        }
+        for (int v : best)
+            if (v != -1)
+                landmarks.push_back(v);
+    }
+
+    // Top up empty sectors (or choose all landmarks) at random.
+    std::mt19937 rng(12345);
+    std::shuffle(candidates.begin(), candidates.end(), rng);
+    for (int v : candidates)
+    {
+        if ((int)landmarks.size() >= k)
+            break;
+        if (std::find(landmarks.begin(), landmarks.end(), v) == landmarks.end())
+            landmarks.push_back(v);
+    }
+    return landmarks;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_reduce.h>
+
+#include "dijkstra.hpp"
+#include "dimacs.hpp"
+#include "graph.hpp"
+#include "heaps.hpp"
+
+// Goal-directed point-to-point search. h(v) must be a lower bound on the
+// distance from v to target; the heuristic need not be consistent, since a
+// node whose distance improves after it was settled is simply queued again,
+// so the first pop of the target is optimal. Keys are dist + h, which is not
+// monotone in general, so this always uses the indexed 4-ary heap.
+template <typename Heuristic>
+PathResult astar(const CsrGraph &graph, int source, int target, Heuristic &&h)
+{
+    const int n = graph.num_nodes();
+    std::vector<long long> dist(n + 1, DIST_INF);
+    std::vector<int> parent(n + 1, -1);
+    QuaternaryHeap<long long> pq(n);
+
+    PathResult result;
+    dist[source] = 0;
+    pq.push_or_decrease(h(source), source);
+
+    while (!pq.empty())
+    {
+        int u = pq.pop().second;
+        ++result.settled;
+        if (u == target)
+            break;
+
+        long long d = dist[u];
+        auto targets = graph.targets(u);
+        auto weights = graph.weights(u);
+        for (std::size_t i = 0; i < targets.size(); ++i)
+        {
+            int v = targets[i];
+            long long new_dist = d + weights[i];
+            if (new_dist < dist[v])
+            {
+                dist[v] = new_dist;
+                parent[v] = u;
+                pq.push_or_decrease(new_dist + h(v), v);
+            }
+        }
+    }
+
+    result.distance = dist[target];
+    if (result.distance < DIST_INF)
+    {
+        for (int v = target; v != -1; v = parent[v])
+            result.path.push_back(v);
+        std::reverse(result.path.begin(), result.path.end());
+    }
+    return result;
+}
+
+// Euclidean lower bounds from DIMACS coordinates. Coordinate units rarely
+// match weight units (and travel-time graphs have no fixed ratio), so the
+// Euclidean distance is scaled by the smallest weight / length ratio over
+// all arcs, which makes the bound admissible and consistent by construction.
+class CoordinateBounds
+{
+public:
+    CoordinateBounds(const CsrGraph &graph, std::vector<Coord> coords) : coords_(std::move(coords))
+    {
+        const int n = graph.num_nodes();
+        scale_ = tbb::parallel_reduce(
+            tbb::blocked_range<int>(1, n + 1), INFINITY,
+            [&](const tbb::blocked_range<int> &r, double best)
+            {
+                for (int u = r.begin(); u < r.end(); ++u)
+                {
+                    auto targets = graph.targets(u);
+                    auto weights = graph.weights(u);
+                    for (std::size_t i = 0; i < targets.size(); ++i)
+                    {
+                        double len = length(u, targets[i]);
+                        if (len > 0)
+                            best = std::min(best, weights[i] / len);
+                    }
+                }
+                return best;
+            },
+            [](double a, double b) { return std::min(a, b); });
+        if (!std::isfinite(scale_))
+            scale_ = 0.0;
+    }
+
+    double scale() const { return scale_; }
+
+    // Lower bound on the distance from v to target.
+    long long bound(int v, int target) const { return (long long)(scale_ * length(v, target)); }
+
+private:
+    double length(int a, int b) const
+    {
+        double dx = (double)coords_[a].x - coords_[b].x;
+        double dy = (double)coords_[a].y - coords_[b].y;
+        return std::sqrt(dx * dx + dy * dy);
+    }
+
+    std::vector<Coord> coords_;
+    double scale_ = 0.0;
+};
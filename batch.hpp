@@ -0,0 +1,160 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_group.h>
+
+#include "dijkstra.hpp"
+#include "graph.hpp"
+#include "heaps.hpp"
+#include "threading.hpp"
+#include "tree_cache.hpp"
+
+struct QueryPair
+{
+    int source;
+    int target;
+};
+
+// Reads "source target" pairs, one per line; blank lines and lines starting
+// with '#' are skipped.
+inline bool read_query_pairs(std::istream &in, int n_nodes, std::vector<QueryPair> &queries)
+{
+    std::string line;
+    std::size_t line_no = 0;
+    while (std::getline(in, line))
+    {
+        ++line_no;
+        std::size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#')
+            continue;
+
+        std::istringstream ss(line);
+        QueryPair q;
+        if (!(ss >> q.source >> q.target) || q.source < 1 || q.source > n_nodes || q.target < 1 ||
+            q.target > n_nodes)
+        {
+            std::cerr << "Invalid query at line " << line_no << ": " << line << "\n";
+            return false;
+        }
+        queries.push_back(q);
+    }
+    return true;
+}
+
+struct BatchStats
+{
+    std::size_t queries = 0;
+    double seconds = 0.0;
+    double p50_us = 0.0;
+    double p99_us = 0.0;
+
+    double queries_per_s() const { return seconds > 0 ? queries / seconds : 0.0; }
+};
+
+// Nearest-rank percentile of an ascending sample, q in [0, 1].
+inline double percentile(const std::vector<double> &sorted, double q)
+{
+    if (sorted.empty())
+        return 0.0;
+    std::size_t rank = (std::size_t)(q * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+// Answers queries[begin, end) concurrently on the current arena, one
+// sequential search per query that stops once its target is settled. Each
+// worker reuses its own QueryWorkspace across the queries it runs. Sources
+// held by cache (if any) are answered from their tree instead.
+template <template <typename> class Queue>
+void answer_queries(const CsrGraph &graph, const std::vector<QueryPair> &queries, std::size_t begin, std::size_t end,
+                    std::vector<long long> &distances, std::vector<double> &latency_us,
+                    SourceTreeCache *cache = nullptr)
+{
+    tbb::enumerable_thread_specific<QueryWorkspace<Queue>> workspaces(graph, false);
+    tbb::parallel_for(begin, end, [&](std::size_t i)
+                      {
+        auto t0 = std::chrono::steady_clock::now();
+        PathResult cached;
+        if (cache && cache->lookup<Queue>(graph, queries[i].source, queries[i].target, false, cached))
+            distances[i] = cached.distance;
+        else
+        {
+            auto &ws = workspaces.local();
+            dijkstra_sequential(graph, queries[i].source, ws, {&queries[i].target, 1});
+            distances[i] = ws.dist(queries[i].target);
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        latency_us[i] = std::chrono::duration<double, std::micro>(t1 - t0).count(); });
+}
+
+inline BatchStats batch_stats(std::vector<double> &latency_us, double seconds)
+{
+    std::sort(latency_us.begin(), latency_us.end());
+    BatchStats stats;
+    stats.queries = latency_us.size();
+    stats.seconds = seconds;
+    stats.p50_us = percentile(latency_us, 0.50);
+    stats.p99_us = percentile(latency_us, 0.99);
+    return stats;
+}
+
+// Answers independent queries on the TBB pool. distances[i] is DIST_INF
+// when the target is unreachable.
+template <template <typename> class Queue>
+BatchStats run_batch(const CsrGraph &graph, const std::vector<QueryPair> &queries, std::vector<long long> &distances,
+                     SourceTreeCache *cache = nullptr)
+{
+    distances.assign(queries.size(), DIST_INF);
+    std::vector<double> latency_us(queries.size());
+
+    auto start = std::chrono::steady_clock::now();
+    answer_queries<Queue>(graph, queries, 0, queries.size(), distances, latency_us, cache);
+    auto end = std::chrono::steady_clock::now();
+    return batch_stats(latency_us, std::chrono::duration<double>(end - start).count());
+}
+
+// Same, with the queries split over the execution domains in proportion to
+// their threads. Each share runs in its domain's arena against the domain's
+// graph replica, so a NUMA node's workers only read local memory.
+template <template <typename> class Queue>
+BatchStats run_batch(std::vector<ExecutionDomain> &domains, const std::vector<QueryPair> &queries,
+                     std::vector<long long> &distances, SourceTreeCache *cache = nullptr)
+{
+    if (domains.size() == 1)
+        return domains[0].arena->execute([&]
+                                         { return run_batch<Queue>(domains[0].graph, queries, distances, cache); });
+
+    distances.assign(queries.size(), DIST_INF);
+    std::vector<double> latency_us(queries.size());
+
+    std::size_t total_threads = 0;
+    for (const auto &d : domains)
+        total_threads += d.threads;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<tbb::task_group> groups(domains.size());
+    std::size_t begin = 0, threads_before = 0;
+    for (std::size_t i = 0; i < domains.size(); ++i)
+    {
+        threads_before += domains[i].threads;
+        std::size_t end = queries.size() * threads_before / total_threads;
+        auto &d = domains[i];
+        d.arena->execute([&, begin, end]
+                         { groups[i].run([&, begin, end]
+                                         { answer_queries<Queue>(d.graph, queries, begin, end, distances, latency_us, cache); }); });
+        begin = end;
+    }
+    for (std::size_t i = 0; i < domains.size(); ++i)
+        domains[i].arena->execute([&]
+                                  { groups[i].wait(); });
+    auto end = std::chrono::steady_clock::now();
+    return batch_stats(latency_us, std::chrono::duration<double>(end - start).count());
+}
@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "dijkstra.hpp"
+#include "graph_cache.hpp"
+#include "heaps.hpp"
+
+// Runs dijkstra_sequential with every priority-queue backend from the same
+// sampled sources and reports per-query timings, then compares 64- and
+// 32-bit labels with and without parents; distances are checked against the
+// lazy binary heap.
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <graph.gr|graph.csr> [sources=5] [repeats=3]\n";
+        return 1;
+    }
+
+    std::string filename = argv[1];
+    int n_sources = std::max(1, argc > 2 ? std::stoi(argv[2]) : 5);
+    int repeats = std::max(1, argc > 3 ? std::stoi(argv[3]) : 3);
+
+    CsrGraph graph;
+    int n_nodes = 0;
+    if (!load_graph(filename, graph, n_nodes) || n_nodes == 0)
+        return 1;
+    std::cout << "Graph: " << n_nodes << " nodes, " << graph.num_edges() << " arcs, max weight "
+              << graph.max_weight() << " (auto picks "
+              << queue_kind_name(resolve_queue_kind(QueueKind::Auto, graph.max_weight())) << ")\n";
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> pick(1, n_nodes);
+    std::vector<int> sources(n_sources);
+    for (auto &s : sources)
+        s = pick(rng);
+
+    std::vector<std::vector<long long>> reference;
+    for (int s : sources)
+        reference.push_back(dijkstra_sequential<LazyBinaryHeap>(graph, s).dist);
+
+    std::cout << std::left << std::setw(10) << "queue" << std::right << std::setw(14) << "median ms"
+              << std::setw(14) << "min ms" << std::setw(10) << "check" << "\n";
+
+    for (QueueKind kind : {QueueKind::Binary, QueueKind::Dary, QueueKind::Pairing, QueueKind::Radix, QueueKind::Dial})
+    {
+        if (kind == QueueKind::Dial && graph.max_weight() > DIAL_LIMIT_WEIGHT)
+        {
+            std::cout << std::left << std::setw(10) << queue_kind_name(kind) << "skipped (max weight above "
+                      << DIAL_LIMIT_WEIGHT << ")\n";
+            continue;
+        }
+        std::vector<double> times;
+        bool ok = true;
+        for (int r = 0; r < repeats; ++r)
+        {
+            for (std::size_t i = 0; i < sources.size(); ++i)
+            {
+                auto start = std::chrono::steady_clock::now();
+                auto res = with_queue(kind, [&]<template <typename> class Q>()
+                                      { return dijkstra_sequential<Q>(graph, sources[i]); });
+                auto end = std::chrono::steady_clock::now();
+                times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+                ok &= res.dist == reference[i];
+            }
+        }
+
+        std::sort(times.begin(), times.end());
+        std::cout << std::left << std::setw(10) << queue_kind_name(kind) << std::right << std::fixed
+                  << std::setprecision(3) << std::setw(14) << times[times.size() / 2] << std::setw(14)
+                  << times.front() << std::setw(10) << (ok ? "ok" : "MISMATCH") << "\n";
+        if (!ok)
+            return 1;
+    }
+
+    // Label width and parent tracking, on the queue auto would pick.
+    QueueKind kind = resolve_queue_kind(QueueKind::Auto, graph.max_weight());
+    std::cout << "\n" << std::left << std::setw(14) << "labels" << std::right << std::setw(10) << "median ms"
+              << std::setw(14) << "min ms" << std::setw(10) << "check" << "\n";
+    auto bench_labels = [&]<typename Dist>(const char *name, bool parents)
+    {
+        std::vector<double> times;
+        bool ok = true, overflow = false;
+        for (int r = 0; r < repeats; ++r)
+        {
+            for (std::size_t i = 0; i < sources.size(); ++i)
+            {
+                auto start = std::chrono::steady_clock::now();
+                auto res = with_queue(kind, [&]<template <typename> class Q>()
+                                      { return dijkstra_sequential<Dist, Q>(graph, sources[i], {}, parents); });
+                auto end = std::chrono::steady_clock::now();
+                times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+                overflow |= res.overflow;
+                for (std::size_t v = 0; v < res.dist.size() && ok && !res.overflow; ++v)
+                    ok = res.dist[v] == DistTraits<Dist>::inf ? reference[i][v] == DIST_INF
+                                                              : (long long)res.dist[v] == reference[i][v];
+            }
+        }
+        std::sort(times.begin(), times.end());
+        std::cout << std::left << std::setw(14) << name << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(10) << times[times.size() / 2] << std::setw(14) << times.front() << std::setw(10)
+                  << (overflow ? "overflow" : ok ? "ok" : "MISMATCH") << "\n";
+        return ok;
+    };
+    bool ok = bench_labels.operator()<long long>("i64+parent", true);
+    ok &= bench_labels.operator()<long long>("i64", false);
+    ok &= bench_labels.operator()<std::uint32_t>("u32+parent", true);
+    ok &= bench_labels.operator()<std::uint32_t>("u32", false);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,295 @@
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <tbb/global_control.h>
+#include <tbb/info.h>
+#include <tbb/task_arena.h>
+
+#include "compressed_graph.hpp"
+#include "delta_stepping.hpp"
+#include "dijkstra.hpp"
+#include "graph_cache.hpp"
+#include "heaps.hpp"
+#include "relax_tuning.hpp"
+#include "simd_relax.hpp"
+
+// Repeatable timings for the full-tree engines. Every (graph, variant,
+// threads) cell runs each sampled source `warmup` times untimed, then
+// `repeats` times timed in nanoseconds; the summary covers all timed runs.
+// Distances are checked against the sequential search. The compressed
+// variant is the sequential search over CompressedGraph; graph_bytes is the
+// adjacency size each variant reads.
+
+struct Sample
+{
+    std::string graph;
+    int nodes = 0;
+    std::size_t arcs = 0;
+    std::size_t graph_bytes = 0;
+    std::string variant;
+    std::string queue;
+    int threads = 1;
+    std::string threshold;
+    std::size_t runs = 0;
+    double median_ns = 0, mean_ns = 0, stddev_ns = 0, min_ns = 0, max_ns = 0;
+    bool ok = true;
+};
+
+void summarize(std::vector<double> &ns, Sample &s)
+{
+    std::sort(ns.begin(), ns.end());
+    s.runs = ns.size();
+    s.min_ns = ns.front();
+    s.max_ns = ns.back();
+    s.median_ns = ns.size() % 2 ? ns[ns.size() / 2] : (ns[ns.size() / 2 - 1] + ns[ns.size() / 2]) / 2;
+    double sum = 0;
+    for (double t : ns)
+        sum += t;
+    s.mean_ns = sum / ns.size();
+    double sq = 0;
+    for (double t : ns)
+        sq += (t - s.mean_ns) * (t - s.mean_ns);
+    s.stddev_ns = ns.size() > 1 ? std::sqrt(sq / (ns.size() - 1)) : 0.0;
+}
+
+std::vector<int> parse_int_list(const std::string &text)
+{
+    std::vector<int> out;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ','))
+        if (!item.empty())
+            out.push_back(std::stoi(item));
+    return out;
+}
+
+std::string json_escape(const std::string &text)
+{
+    std::string out;
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+bool write_csv(const std::string &path, const std::vector<Sample> &samples)
+{
+    std::ofstream out(path);
+    out << "graph,nodes,arcs,graph_bytes,variant,queue,threads,threshold,runs,median_ns,mean_ns,stddev_ns,min_ns,max_ns,check\n";
+    out << std::fixed << std::setprecision(0);
+    for (const auto &s : samples)
+        out << s.graph << "," << s.nodes << "," << s.arcs << "," << s.graph_bytes << "," << s.variant << ","
+            << s.queue << "," << s.threads << "," << s.threshold << "," << s.runs << "," << s.median_ns << "," << s.mean_ns << "," << s.stddev_ns
+            << "," << s.min_ns << "," << s.max_ns << "," << (s.ok ? "ok" : "mismatch") << "\n";
+    return (bool)out;
+}
+
+bool write_json(const std::string &path, const std::vector<Sample> &samples, int warmup, int repeats, int n_sources)
+{
+    char host[256] = {};
+    gethostname(host, sizeof host - 1);
+    char date[32] = {};
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof date, "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    std::ofstream out(path);
+    out << std::fixed << std::setprecision(0);
+    out << "{\n  \"host\": \"" << json_escape(host) << "\",\n  \"date\": \"" << date << "\",\n  \"simd\": \""
+        << simd_level_name(simd_level()) << "\",\n  \"warmup\": " << warmup << ",\n  \"repeats\": " << repeats
+        << ",\n  \"sources\": " << n_sources << ",\n  \"results\": [\n";
+    for (std::size_t i = 0; i < samples.size(); ++i)
+    {
+        const auto &s = samples[i];
+        out << "    {\"graph\": \"" << json_escape(s.graph) << "\", \"nodes\": " << s.nodes << ", \"arcs\": " << s.arcs
+            << ", \"graph_bytes\": " << s.graph_bytes << ", \"variant\": \"" << s.variant << "\", \"queue\": \""
+            << s.queue << "\", \"threads\": " << s.threads
+            << ", \"threshold\": \"" << s.threshold << "\", \"runs\": " << s.runs << ", \"median_ns\": " << s.median_ns
+            << ", \"mean_ns\": " << s.mean_ns << ", \"stddev_ns\": " << s.stddev_ns << ", \"min_ns\": " << s.min_ns
+            << ", \"max_ns\": " << s.max_ns << ", \"ok\": " << (s.ok ? "true" : "false") << "}"
+            << (i + 1 < samples.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return (bool)out;
+}
+
+int main(int argc, char **argv)
+{
+    int warmup = 2;
+    int repeats = 10;
+    int n_sources = 5;
+    std::vector<int> thread_counts = {1, (int)tbb::info::default_concurrency()};
+    std::vector<std::string> variants = {"sequential", "parallel", "delta", "compressed"};
+    QueueKind queue = QueueKind::Auto;
+    std::string csv_file, json_file;
+    std::vector<std::string> graphs;
+    bool bad_args = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--warmup" && i + 1 < argc)
+            warmup = std::stoi(argv[++i]);
+        else if (arg == "--repeats" && i + 1 < argc)
+            repeats = std::stoi(argv[++i]);
+        else if (arg == "--sources" && i + 1 < argc)
+            n_sources = std::stoi(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc)
+            thread_counts = parse_int_list(argv[++i]);
+        else if (arg == "--variants" && i + 1 < argc)
+        {
+            variants.clear();
+            std::stringstream ss(argv[++i]);
+            std::string v;
+            while (std::getline(ss, v, ','))
+            {
+                bad_args |= v != "sequential" && v != "parallel" && v != "delta" && v != "compressed";
+                variants.push_back(v);
+            }
+        }
+        else if (arg == "--queue" && i + 1 < argc)
+            bad_args |= !parse_queue_kind(argv[++i], queue);
+        else if (arg == "--csv" && i + 1 < argc)
+            csv_file = argv[++i];
+        else if (arg == "--json" && i + 1 < argc)
+            json_file = argv[++i];
+        else
+            graphs.push_back(arg);
+    }
+    std::sort(thread_counts.begin(), thread_counts.end());
+    thread_counts.erase(std::unique(thread_counts.begin(), thread_counts.end()), thread_counts.end());
+    if (bad_args || graphs.empty() || thread_counts.empty() || thread_counts.front() < 1 || repeats < 1 ||
+        warmup < 0 || n_sources < 1)
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--warmup N] [--repeats N] [--sources N] [--threads 1,2,4,...]"
+                     " [--variants sequential,parallel,delta,compressed] [--queue auto|binary|dary|pairing|radix|dial]"
+                     " [--csv out.csv] [--json out.json] <graph.gr|graph.csr>...\n";
+        return 1;
+    }
+
+    std::vector<Sample> samples;
+    bool all_ok = true;
+    std::cout << std::left << std::setw(24) << "graph" << std::setw(12) << "variant" << std::right << std::setw(8)
+              << "threads" << std::setw(14) << "median us" << std::setw(12) << "stddev us" << std::setw(12)
+              << "min us" << std::setw(10) << "graph MB" << std::setw(10) << "check" << "\n";
+
+    for (const auto &filename : graphs)
+    {
+        CsrGraph graph;
+        int n_nodes = 0;
+        if (!load_graph(filename, graph, n_nodes) || n_nodes == 0)
+            return 1;
+        QueueKind kind = resolve_queue_kind(queue, graph.max_weight());
+
+        // Sources are drawn per graph from a fixed seed so reruns measure
+        // the same searches.
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<int> pick(1, n_nodes);
+        std::vector<int> sources(n_sources);
+        for (auto &s : sources)
+            s = pick(rng);
+
+        std::vector<std::vector<long long>> reference;
+        for (int s : sources)
+            reference.push_back(with_queue(kind, [&]<template <typename> class Q>()
+                                           { return dijkstra_sequential<Q>(graph, s).dist; }));
+        long long delta = default_delta(graph);
+        CompressedGraph compressed;
+        if (std::count(variants.begin(), variants.end(), "compressed") && !CompressedGraph::build(graph, compressed))
+            return 1;
+
+        for (const auto &variant : variants)
+        {
+            for (int threads : thread_counts)
+            {
+                // The sequential search does not depend on the thread count.
+                bool serial = variant == "sequential" || variant == "compressed";
+                if (serial && threads != thread_counts.front())
+                    continue;
+
+                tbb::global_control gc(tbb::global_control::max_allowed_parallelism, threads);
+                tbb::task_arena arena(threads);
+                Sample s;
+                s.graph = filename;
+                s.nodes = n_nodes;
+                s.arcs = graph.num_edges();
+                s.variant = variant;
+                s.queue = variant == "delta" ? "buckets" : queue_kind_name(kind);
+                s.threads = serial ? 1 : threads;
+                s.graph_bytes = variant == "compressed" ? compressed.bytes() : csr_bytes(graph);
+
+                arena.execute([&]
+                              {
+                    if (variant == "parallel")
+                    {
+                        parallel_relax_tuning() = tune_parallel_relax();
+                        s.threshold = parallel_relax_tuning().serial_only()
+                                          ? "off"
+                                          : std::to_string(parallel_relax_tuning().threshold);
+                    }
+
+                    auto run = [&](int source)
+                    {
+                        if (variant == "delta")
+                            return delta_stepping(graph, source, delta).dist;
+                        return with_queue(kind, [&]<template <typename> class Q>()
+                                          {
+                            if (variant == "compressed")
+                                return dijkstra_compressed<Q>(compressed, source).dist;
+                            return variant == "parallel" ? dijkstra_parallel<Q>(graph, source).dist
+                                                         : dijkstra_sequential<Q>(graph, source).dist; });
+                    };
+
+                    std::vector<double> ns;
+                    for (std::size_t i = 0; i < sources.size(); ++i)
+                    {
+                        for (int w = 0; w < warmup; ++w)
+                            s.ok &= run(sources[i]) == reference[i];
+                        for (int r = 0; r < repeats; ++r)
+                        {
+                            auto start = std::chrono::steady_clock::now();
+                            auto dist = run(sources[i]);
+                            auto end = std::chrono::steady_clock::now();
+                            ns.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+                            s.ok &= dist == reference[i];
+                        }
+                    }
+                    summarize(ns, s); });
+
+                all_ok &= s.ok;
+                std::cout << std::left << std::setw(24) << std::filesystem::path(filename).filename().string() << std::setw(12) << variant << std::right
+                          << std::setw(8) << s.threads << std::fixed << std::setprecision(1) << std::setw(14)
+                          << s.median_ns / 1000 << std::setw(12) << s.stddev_ns / 1000 << std::setw(12)
+                          << s.min_ns / 1000 << std::setw(10) << s.graph_bytes / (1024.0 * 1024.0) << std::setw(10)
+                          << (s.ok ? "ok" : "MISMATCH") << "\n";
+                samples.push_back(std::move(s));
+            }
+        }
+    }
+
+    if (!csv_file.empty() && !write_csv(csv_file, samples))
+    {
+        std::cerr << "Could not write " << csv_file << "\n";
+        return 1;
+    }
+    if (!json_file.empty() && !write_json(json_file, samples, warmup, repeats, n_sources))
+    {
+        std::cerr << "Could not write " << json_file << "\n";
+        return 1;
+    }
+    return all_ok ? 0 : 1;
+}
@@ -0,0 +1,60 @@
+#!/usr/bin/env python3
+"""
+Benchmark sweep: generates graphs of increasing size with generate_graph.py
+(fixed seed, so every run measures the same graphs) and runs bench_suite
+over them for a list of thread counts, writing CSV and JSON results.
+"""
+
+import argparse
+import os
+import random
+import subprocess
+import sys
+
+from generate_graph import generate_custom_graph
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Run bench_suite over generated graphs and thread counts',
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+Examples:
+  python3 bench_sweep.py --bench build/bench_suite
+  python3 bench_sweep.py --bench build/bench_suite --sizes 10000,100000 --threads 1,4,8 --out results/v1.2
+        """
+    )
+    parser.add_argument('--bench', default='./bench_suite', help='Path to the bench_suite executable')
+    parser.add_argument('--sizes', default='1000,10000,100000,1000000', help='Comma-separated node counts')
+    parser.add_argument('--edges-per-node', type=int, default=10, help='Edges per node')
+    parser.add_argument('--max-weight', type=int, default=1000, help='Maximum edge weight')
+    parser.add_argument('--threads', default='1,2,4,8', help='Comma-separated thread counts')
+    parser.add_argument('--warmup', type=int, default=2, help='Untimed runs per source')
+    parser.add_argument('--repeats', type=int, default=10, help='Timed runs per source')
+    parser.add_argument('--sources', type=int, default=5, help='Sampled sources per graph')
+    parser.add_argument('--graph-dir', default='bench_graphs', help='Where generated graphs are kept')
+    parser.add_argument('--out', default='bench_results', help='Output prefix for .csv and .json')
+    parser.add_argument('--seed', type=int, default=1, help='Random seed for the generated graphs')
+    args = parser.parse_args()
+
+    os.makedirs(args.graph_dir, exist_ok=True)
+    graphs = []
+    for size in (int(s) for s in args.sizes.split(',') if s):
+        filename = os.path.join(args.graph_dir, f'sweep_{size}_{args.edges_per_node}_{args.seed}.gr')
+        if not os.path.exists(filename):
+            random.seed(args.seed * 1000003 + size)
+            generate_custom_graph(filename, size, args.edges_per_node, args.max_weight)
+        graphs.append(filename)
+
+    out_dir = os.path.dirname(args.out)
+    if out_dir:
+        os.makedirs(out_dir, exist_ok=True)
+    cmd = [args.bench,
+           '--warmup', str(args.warmup), '--repeats', str(args.repeats), '--sources', str(args.sources),
+           '--threads', args.threads, '--csv', args.out + '.csv', '--json', args.out + '.json'] + graphs
+    print(' '.join(cmd))
+    return subprocess.call(cmd)
+
+
+if __name__ == '__main__':
+    sys.exit(main())
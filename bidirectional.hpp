@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "dijkstra.hpp"
+#include "graph.hpp"
+#include "heaps.hpp"
+
+// Bidirectional Dijkstra: alternates single settle steps of a forward search
+// on graph and a backward search on its reverse. Every relaxed arc that
+// reaches a node labelled by the other side offers a candidate path; the
+// search stops once the two last settled keys add up to at least the best
+// candidate, which is then optimal.
+template <template <typename> class Queue = QuaternaryHeap>
+PathResult bidirectional_dijkstra(const CsrGraph &forward, const CsrGraph &backward, int source, int target)
+{
+    PathResult result;
+    if (source == target)
+    {
+        result.distance = 0;
+        result.path = {source};
+        return result;
+    }
+
+    const int n = forward.num_nodes();
+
+    struct Side
+    {
+        const CsrGraph &graph;
+        std::vector<long long> dist;
+        std::vector<int> parent;
+        Queue<long long> pq;
+        long long last_key = 0;
+
+        Side(const CsrGraph &g, int n, int root)
+            : graph(g), dist(n + 1, DIST_INF), parent(n + 1, -1), pq(n, g.max_weight())
+        {
+            dist[root] = 0;
+            pq.push_or_decrease(0, root);
+        }
+    };
+
+    Side sides[2] = {Side(forward, n, source), Side(backward, n, target)};
+    long long best = DIST_INF;
+    int meet = -1;
+
+    for (int turn = 0; !sides[0].pq.empty() && !sides[1].pq.empty(); turn ^= 1)
+    {
+        Side &side = sides[turn];
+        const Side &other = sides[turn ^ 1];
+
+        auto [d, u] = side.pq.pop();
+        if (d != side.dist[u])
+            continue;
+        side.last_key = d;
+        ++result.settled;
+        if (sides[0].last_key + sides[1].last_key >= best)
+            break;
+
+        auto targets = side.graph.targets(u);
+        auto weights = side.graph.weights(u);
+        for (std::size_t i = 0; i < targets.size(); ++i)
+        {
+            int v = targets[i];
+            long long new_dist = d + weights[i];
+            if (new_dist < side.dist[v])
+            {
+                side.dist[v] = new_dist;
+                side.parent[v] = u;
+                side.pq.push_or_decrease(new_dist, v);
+            }
+            if (other.dist[v] < DIST_INF && new_dist + other.dist[v] < best)
+            {
+                best = new_dist + other.dist[v];
+                meet = v;
+            }
+        }
+    }
+
+    if (meet == -1)
+        return result;
+
+    // The labels at the meeting node are real path lengths summing to best.
+    result.distance = sides[0].dist[meet] + sides[1].dist[meet];
+    for (int v = meet; v != -1; v = sides[0].parent[v])
+        result.path.push_back(v);
+    std::reverse(result.path.begin(), result.path.end());
+    for (int v = sides[1].parent[meet]; v != -1; v = sides[1].parent[v])
+        result.path.push_back(v);
+    return result;
+}
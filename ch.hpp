@@ -0,0 +1,706 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+
+#include "dijkstra.hpp"
+#include "graph.hpp"
+#include "graph_cache.hpp"
+#include "heaps.hpp"
+#include "mapped_file.hpp"
+
+// Contraction Hierarchies. Nodes are contracted one by one in order of
+// importance; contracting v removes it and adds a shortcut u -> x (via v)
+// for every pair of remaining neighbours whose shortest connection ran
+// through v. A query then only needs arcs leading to more important nodes:
+// a forward search from the source and a backward search from the target,
+// both climbing the hierarchy, meet at the highest node of a shortest path.
+//
+// Arcs are stored at their less important endpoint. up(u) lists u -> x with
+// rank[x] > rank[u]; down(x) lists u -> x with rank[u] > rank[x], keyed by
+// the source u. middle is the contracted node a shortcut bypasses, or -1 for
+// an original arc. Weights are 64-bit since shortcuts can exceed int range.
+class ChArcs
+{
+public:
+    ChArcs() = default;
+
+    ChArcs(std::span<const std::uint64_t> offsets, std::span<const int> nodes, std::span<const long long> weights,
+           std::span<const int> middle)
+        : offsets_(offsets), nodes_(nodes), weights_(weights), middle_(middle)
+    {
+    }
+
+    std::size_t begin(int u) const { return offsets_[u]; }
+    std::size_t end(int u) const { return offsets_[u + 1]; }
+    int node(std::size_t a) const { return nodes_[a]; }
+    long long weight(std::size_t a) const { return weights_[a]; }
+    int middle(std::size_t a) const { return middle_[a]; }
+    std::size_t size() const { return nodes_.size(); }
+
+    // The arc at u leading to (up) or coming from (down) v; arcs are unique
+    // per node pair.
+    std::size_t find(int u, int v) const
+    {
+        for (std::size_t a = begin(u); a < end(u); ++a)
+            if (nodes_[a] == v)
+                return a;
+        return end(u);
+    }
+
+    std::span<const std::uint64_t> offsets_;
+    std::span<const int> nodes_;
+    std::span<const long long> weights_;
+    std::span<const int> middle_;
+};
+
+struct ChBuildStats
+{
+    std::size_t shortcuts = 0;
+    std::size_t rounds = 0;
+    double seconds = 0.0;
+};
+
+struct ChFileHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint64_t n_nodes;
+    std::uint64_t n_arcs;
+    std::uint64_t source_size;
+    std::int64_t source_mtime;
+    std::uint64_t n_up;
+    std::uint64_t n_down;
+    // rank, then offsets/nodes/weights/middle of up, then of down.
+    std::uint64_t pos[9];
+};
+
+inline constexpr char CH_FILE_MAGIC[8] = {'D', 'J', 'K', 'C', 'H', '\0', '\0', '\0'};
+inline constexpr std::uint32_t CH_FILE_VERSION = 1;
+
+class ContractionHierarchy
+{
+public:
+    ContractionHierarchy() = default;
+
+    int num_nodes() const { return rank_.empty() ? 0 : (int)rank_.size() - 1; }
+    int rank(int v) const { return rank_[v]; }
+    const ChArcs &up() const { return up_; }
+    const ChArcs &down() const { return down_; }
+
+    // Settle limits for witness searches during contraction and during
+    // priority estimation. A search that gives up keeps the shortcut, which
+    // is always safe; it only makes the hierarchy larger.
+    static constexpr int WITNESS_SETTLE_LIMIT = 500;
+    static constexpr int ESTIMATE_SETTLE_LIMIT = 50;
+
+    static ContractionHierarchy build(const CsrGraph &graph, ChBuildStats *stats = nullptr);
+
+    bool write(const std::string &path, const CsrGraph &graph, const SourceStamp &stamp) const;
+    static bool map(const std::string &path, const CsrGraph &graph, const SourceStamp &stamp,
+                    ContractionHierarchy &ch);
+
+private:
+    struct OwnedArrays
+    {
+        std::vector<int> rank;
+        std::vector<std::uint64_t> offsets[2];
+        std::vector<int> nodes[2];
+        std::vector<long long> weights[2];
+        std::vector<int> middle[2];
+    };
+
+    std::span<const int> rank_;
+    ChArcs up_;
+    ChArcs down_;
+    std::shared_ptr<const void> storage_;
+};
+
+// Working graph during contraction: adjacency lists over the remaining nodes,
+// at most one arc per ordered pair.
+struct ChOverlayArc
+{
+    int node;
+    int middle;
+    long long weight;
+};
+
+// Bounded local Dijkstra used to look for witness paths. Each worker keeps
+// one, and only touched entries are reset between searches.
+class ChWitnessSearch
+{
+public:
+    explicit ChWitnessSearch(int n) : dist_(n + 1, DIST_INF), target_epoch_(n + 1, 0), pq_(n) {}
+
+    // Distances from source in the overlay without skip and contracted nodes.
+    // The search ends once every node in targets is settled, the next key
+    // exceeds limit, or settle_limit nodes are settled; distance(v) is then
+    // the length of some path, and exact for settled nodes.
+    void run(const std::vector<std::vector<ChOverlayArc>> &out, const std::vector<char> &contracted, int source,
+             int skip, const std::vector<ChOverlayArc> &targets, long long limit, int settle_limit)
+    {
+        for (int v : touched_)
+            dist_[v] = DIST_INF;
+        touched_.clear();
+        while (!pq_.empty())
+            pq_.pop();
+
+        ++epoch_;
+        std::size_t remaining = 0;
+        for (const auto &arc : targets)
+        {
+            if (arc.node != source && !contracted[arc.node] && target_epoch_[arc.node] != epoch_)
+            {
+                target_epoch_[arc.node] = epoch_;
+                ++remaining;
+            }
+        }
+
+        dist_[source] = 0;
+        touched_.push_back(source);
+        pq_.push_or_decrease(0, source);
+        int settled = 0;
+        while (!pq_.empty() && remaining > 0)
+        {
+            auto [d, u] = pq_.pop();
+            if (d > limit || ++settled > settle_limit)
+                break;
+            if (target_epoch_[u] == epoch_)
+                --remaining;
+            for (const auto &arc : out[u])
+            {
+                int v = arc.node;
+                if (v == skip || contracted[v])
+                    continue;
+                long long new_dist = d + arc.weight;
+                if (new_dist < dist_[v])
+                {
+                    if (dist_[v] == DIST_INF)
+                        touched_.push_back(v);
+                    dist_[v] = new_dist;
+                    pq_.push_or_decrease(new_dist, v);
+                }
+            }
+        }
+    }
+
+    long long distance(int v) const { return dist_[v]; }
+
+private:
+    std::vector<long long> dist_;
+    std::vector<int> touched_;
+    std::vector<std::uint32_t> target_epoch_;
+    std::uint32_t epoch_ = 0;
+    QuaternaryHeap<long long> pq_;
+};
+
+struct ChShortcut
+{
+    int from;
+    int to;
+    long long weight;
+};
+
+// Shortcuts needed to contract v now. With shortcuts null only the count is
+// returned, for priority estimation.
+inline std::size_t ch_shortcuts_for(int v, const std::vector<std::vector<ChOverlayArc>> &out,
+                                    const std::vector<std::vector<ChOverlayArc>> &in,
+                                    const std::vector<char> &contracted, ChWitnessSearch &witness,
+                                    std::vector<ChShortcut> *shortcuts)
+{
+    long long max_out = 0;
+    for (const auto &arc : out[v])
+        if (!contracted[arc.node])
+            max_out = std::max(max_out, arc.weight);
+
+    std::size_t count = 0;
+    for (const auto &in_arc : in[v])
+    {
+        int u = in_arc.node;
+        if (contracted[u])
+            continue;
+        witness.run(out, contracted, u, v, out[v], in_arc.weight + max_out,
+                    shortcuts ? ContractionHierarchy::WITNESS_SETTLE_LIMIT : ContractionHierarchy::ESTIMATE_SETTLE_LIMIT);
+        for (const auto &out_arc : out[v])
+        {
+            int x = out_arc.node;
+            if (x == u || contracted[x])
+                continue;
+            long long via = in_arc.weight + out_arc.weight;
+            if (witness.distance(x) <= via)
+                continue;
+            ++count;
+            if (shortcuts)
+                shortcuts->push_back({u, x, via});
+        }
+    }
+    return count;
+}
+
+// Inserts or lowers the arc to node in list.
+inline void ch_overlay_relax(std::vector<ChOverlayArc> &list, int node, long long weight, int middle)
+{
+    for (auto &arc : list)
+    {
+        if (arc.node == node)
+        {
+            if (weight < arc.weight)
+            {
+                arc.weight = weight;
+                arc.middle = middle;
+            }
+            return;
+        }
+    }
+    list.push_back({node, middle, weight});
+}
+
+// Contracts the graph in rounds. Each round selects an independent set of
+// nodes whose priority (edge difference plus contracted neighbours) is a
+// strict local minimum and contracts them concurrently: the witness searches
+// run in parallel against the unchanged overlay, with the whole set treated
+// as already removed so no search can rely on a node contracted alongside,
+// and the resulting shortcuts are merged serially. Priorities of the
+// affected neighbours are then recomputed in parallel.
+inline ContractionHierarchy ContractionHierarchy::build(const CsrGraph &graph, ChBuildStats *stats)
+{
+    auto start = std::chrono::steady_clock::now();
+    const int n = graph.num_nodes();
+
+    std::vector<std::vector<ChOverlayArc>> out(n + 1), in(n + 1);
+    for (int u = 1; u <= n; ++u)
+    {
+        auto targets = graph.targets(u);
+        auto weights = graph.weights(u);
+        for (std::size_t i = 0; i < targets.size(); ++i)
+        {
+            if (targets[i] == u)
+                continue;
+            ch_overlay_relax(out[u], targets[i], weights[i], -1);
+            ch_overlay_relax(in[targets[i]], u, weights[i], -1);
+        }
+    }
+
+    std::vector<char> contracted(n + 1, 0);
+    std::vector<int> deleted_neighbours(n + 1, 0);
+    std::vector<long long> priority(n + 1, 0);
+    tbb::enumerable_thread_specific<ChWitnessSearch> witnesses(n);
+
+    auto update_priority = [&](int v)
+    {
+        std::size_t added = ch_shortcuts_for(v, out, in, contracted, witnesses.local(), nullptr);
+        priority[v] = 2 * ((long long)added - (long long)(out[v].size() + in[v].size())) + deleted_neighbours[v];
+    };
+
+    std::vector<int> remaining;
+    remaining.reserve(n);
+    for (int v = 1; v <= n; ++v)
+        remaining.push_back(v);
+    tbb::parallel_for(std::size_t(0), remaining.size(), [&](std::size_t i)
+                      { update_priority(remaining[i]); });
+
+    auto owned = std::make_shared<OwnedArrays>();
+    owned->rank.assign(n + 1, 0);
+    // Arcs recorded at contraction time, per node, before CSR packing.
+    std::vector<std::vector<ChOverlayArc>> up_lists(n + 1), down_lists(n + 1);
+
+    auto before = [&](int a, int b) { return priority[a] < priority[b] || (priority[a] == priority[b] && a < b); };
+
+    std::vector<char> selected_mark(n + 1, 0);
+    std::vector<char> touched_mark(n + 1, 0);
+    std::vector<int> selected, touched;
+    std::vector<std::vector<ChShortcut>> shortcuts;
+    std::size_t n_shortcuts = 0, rounds = 0;
+    int next_rank = 0;
+
+    while (!remaining.empty())
+    {
+        ++rounds;
+        selected.clear();
+        for (int v : remaining)
+        {
+            bool minimal = true;
+            for (const auto &arc : out[v])
+                minimal = minimal && !before(arc.node, v);
+            for (const auto &arc : in[v])
+                minimal = minimal && !before(arc.node, v);
+            if (minimal)
+                selected.push_back(v);
+        }
+
+        for (int v : selected)
+            contracted[v] = selected_mark[v] = 1;
+
+        shortcuts.assign(selected.size(), {});
+        tbb::parallel_for(std::size_t(0), selected.size(), [&](std::size_t i)
+                          { ch_shortcuts_for(selected[i], out, in, contracted, witnesses.local(), &shortcuts[i]); });
+
+        touched.clear();
+        for (std::size_t i = 0; i < selected.size(); ++i)
+        {
+            int v = selected[i];
+            owned->rank[v] = next_rank++;
+            up_lists[v] = std::move(out[v]);
+            down_lists[v] = std::move(in[v]);
+
+            auto detach = [&](const std::vector<ChOverlayArc> &arcs, std::vector<std::vector<ChOverlayArc>> &lists)
+            {
+                for (const auto &arc : arcs)
+                {
+                    auto &list = lists[arc.node];
+                    list.erase(std::remove_if(list.begin(), list.end(), [&](const ChOverlayArc &a)
+                                              { return a.node == v; }),
+                               list.end());
+                    ++deleted_neighbours[arc.node];
+                    if (!touched_mark[arc.node])
+                    {
+                        touched_mark[arc.node] = 1;
+                        touched.push_back(arc.node);
+                    }
+                }
+            };
+            detach(up_lists[v], in);
+            detach(down_lists[v], out);
+
+            for (const auto &s : shortcuts[i])
+            {
+                ch_overlay_relax(out[s.from], s.to, s.weight, v);
+                ch_overlay_relax(in[s.to], s.from, s.weight, v);
+            }
+            n_shortcuts += shortcuts[i].size();
+        }
+        for (int u : touched)
+            touched_mark[u] = 0;
+
+        remaining.erase(std::remove_if(remaining.begin(), remaining.end(), [&](int v)
+                                       { return selected_mark[v] != 0; }),
+                        remaining.end());
+        tbb::parallel_for(std::size_t(0), touched.size(), [&](std::size_t i)
+                          { update_priority(touched[i]); });
+    }
+
+    // Pack the recorded arcs into CSR.
+    std::vector<std::vector<ChOverlayArc>> *lists[2] = {&up_lists, &down_lists};
+    for (int side = 0; side < 2; ++side)
+    {
+        auto &arcs = *lists[side];
+        auto &offsets = owned->offsets[side];
+        offsets.assign(n + 2, 0);
+        for (int v = 1; v <= n; ++v)
+            offsets[v + 1] = offsets[v] + arcs[v].size();
+        std::size_t m = offsets[n + 1];
+        owned->nodes[side].resize(m);
+        owned->weights[side].resize(m);
+        owned->middle[side].resize(m);
+        for (int v = 1; v <= n; ++v)
+        {
+            std::size_t a = offsets[v];
+            for (const auto &arc : arcs[v])
+            {
+                owned->nodes[side][a] = arc.node;
+                owned->weights[side][a] = arc.weight;
+                owned->middle[side][a] = arc.middle;
+                ++a;
+            }
+            std::vector<ChOverlayArc>().swap(arcs[v]);
+        }
+    }
+
+    ContractionHierarchy ch;
+    ch.rank_ = owned->rank;
+    ch.up_ = ChArcs(owned->offsets[0], owned->nodes[0], owned->weights[0], owned->middle[0]);
+    ch.down_ = ChArcs(owned->offsets[1], owned->nodes[1], owned->weights[1], owned->middle[1]);
+    ch.storage_ = std::move(owned);
+
+    if (stats)
+    {
+        stats->shortcuts = n_shortcuts;
+        stats->rounds = rounds;
+        stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return ch;
+}
+
+inline bool ContractionHierarchy::write(const std::string &path, const CsrGraph &graph, const SourceStamp &stamp) const
+{
+    ChFileHeader header{};
+    std::memcpy(header.magic, CH_FILE_MAGIC, sizeof header.magic);
+    header.version = CH_FILE_VERSION;
+    header.byte_order = GRAPH_CACHE_BYTE_ORDER;
+    header.n_nodes = num_nodes();
+    header.n_arcs = graph.num_edges();
+    header.source_size = stamp.size;
+    header.source_mtime = stamp.mtime;
+    header.n_up = up_.size();
+    header.n_down = down_.size();
+
+    const ChArcs *sides[2] = {&up_, &down_};
+    std::pair<const void *, std::size_t> sections[9];
+    sections[0] = {rank_.data(), rank_.size_bytes()};
+    for (int side = 0; side < 2; ++side)
+    {
+        const ChArcs &arcs = *sides[side];
+        sections[1 + 4 * side] = {arcs.offsets_.data(), arcs.offsets_.size_bytes()};
+        sections[2 + 4 * side] = {arcs.nodes_.data(), arcs.nodes_.size_bytes()};
+        sections[3 + 4 * side] = {arcs.weights_.data(), arcs.weights_.size_bytes()};
+        sections[4 + 4 * side] = {arcs.middle_.data(), arcs.middle_.size_bytes()};
+    }
+    std::uint64_t pos = sizeof header;
+    for (int i = 0; i < 9; ++i)
+    {
+        header.pos[i] = align_up(pos, 64);
+        pos = header.pos[i] + sections[i].second;
+    }
+
+    std::vector<FileSection> blocks{{0, &header, sizeof header}};
+    for (int i = 0; i < 9; ++i)
+        blocks.push_back({header.pos[i], sections[i].first, sections[i].second});
+    return write_file_sections(path, blocks);
+}
+
+// Maps a CH file built from the same source file as graph.
+inline bool ContractionHierarchy::map(const std::string &path, const CsrGraph &graph, const SourceStamp &stamp,
+                                      ContractionHierarchy &ch)
+{
+    auto file = map_file(path);
+    if (!file || file->size() < sizeof(ChFileHeader))
+        return false;
+
+    ChFileHeader header;
+    std::memcpy(&header, file->data(), sizeof header);
+    if (std::memcmp(header.magic, CH_FILE_MAGIC, sizeof header.magic) != 0 || header.version != CH_FILE_VERSION ||
+        header.byte_order != GRAPH_CACHE_BYTE_ORDER)
+        return false;
+    if (header.n_nodes != (std::uint64_t)graph.num_nodes() || header.n_arcs != graph.num_edges() ||
+        header.source_size != stamp.size || header.source_mtime != stamp.mtime)
+        return false;
+
+    const std::uint64_t n = header.n_nodes;
+    const std::uint64_t counts[2] = {header.n_up, header.n_down};
+    std::uint64_t bytes[9];
+    bytes[0] = (n + 1) * sizeof(int);
+    for (int side = 0; side < 2; ++side)
+    {
+        bytes[1 + 4 * side] = (n + 2) * sizeof(std::uint64_t);
+        bytes[2 + 4 * side] = counts[side] * sizeof(int);
+        bytes[3 + 4 * side] = counts[side] * sizeof(long long);
+        bytes[4 + 4 * side] = counts[side] * sizeof(int);
+    }
+    for (int i = 0; i < 9; ++i)
+        if (header.pos[i] % 64 || header.pos[i] + bytes[i] > file->size())
+            return false;
+
+    const char *base = file->data();
+    ch.rank_ = std::span((const int *)(base + header.pos[0]), n + 1);
+    ChArcs *sides[2] = {&ch.up_, &ch.down_};
+    for (int side = 0; side < 2; ++side)
+    {
+        auto offsets = std::span((const std::uint64_t *)(base + header.pos[1 + 4 * side]), n + 2);
+        if (offsets.front() != 0 || offsets.back() != counts[side])
+            return false;
+        *sides[side] = ChArcs(offsets, std::span((const int *)(base + header.pos[2 + 4 * side]), counts[side]),
+                              std::span((const long long *)(base + header.pos[3 + 4 * side]), counts[side]),
+                              std::span((const int *)(base + header.pos[4 + 4 * side]), counts[side]));
+    }
+    ch.storage_ = std::move(file);
+    return true;
+}
+
+inline std::string ch_file_path(const std::string &filename)
+{
+    return filename + ".ch";
+}
+
+// Maps path (default "<graph_file>.ch") when it was built from graph_file as
+// it is now, and otherwise builds the hierarchy and saves it there.
+inline void load_contraction_hierarchy(const std::string &graph_file, const CsrGraph &graph, std::string path,
+                                       ContractionHierarchy &ch, std::ostream &info)
+{
+    if (path.empty())
+        path = ch_file_path(graph_file);
+    SourceStamp stamp;
+    stat_source(graph_file, stamp);
+    if (ContractionHierarchy::map(path, graph, stamp, ch))
+    {
+        info << "Mapped contraction hierarchy from " << path << "\n";
+        return;
+    }
+
+    ChBuildStats stats;
+    ch = ContractionHierarchy::build(graph, &stats);
+    info << "Built contraction hierarchy in " << stats.seconds * 1000.0 << " ms (" << stats.shortcuts
+         << " shortcuts, " << stats.rounds << " rounds)\n";
+    if (!ch.write(path, graph, stamp))
+        std::cerr << "Warning: could not write contraction hierarchy " << path << "\n";
+}
+
+// Appends the original nodes of arc from -> to (via middle) after from.
+// A shortcut from -> to via m is the pair from -> m (stored at m in down) and
+// m -> to (stored at m in up); both halves are unpacked in turn.
+inline void ch_unpack(const ContractionHierarchy &ch, int from, int to, int middle, std::vector<int> &path)
+{
+    struct Pending
+    {
+        int from;
+        int to;
+        int middle;
+    };
+    std::vector<Pending> stack = {{from, to, middle}};
+    while (!stack.empty())
+    {
+        Pending arc = stack.back();
+        stack.pop_back();
+        if (arc.middle == -1)
+        {
+            path.push_back(arc.to);
+            continue;
+        }
+        int m = arc.middle;
+        stack.push_back({m, arc.to, ch.up().middle(ch.up().find(m, arc.to))});
+        stack.push_back({arc.from, m, ch.down().middle(ch.down().find(m, arc.from))});
+    }
+}
+
+// One upward search from root over arcs, e.g. (up, down) for a forward and
+// (down, up) for a backward search. visit(v, d) is called for every settled
+// node that is not stalled; its label d is then exact. Runs in ws so
+// repeated searches only pay for what they touch.
+template <typename Visit>
+void ch_upward_search(const ChArcs &arcs, const ChArcs &stall_arcs, int root, QueryWorkspace<QuaternaryHeap> &ws,
+                      Visit &&visit)
+{
+    ws.reset();
+    auto &pq = ws.queue();
+    ws.label(root, 0, -1);
+    pq.push_or_decrease(0, root);
+    while (!pq.empty())
+    {
+        auto [d, u] = pq.pop();
+
+        bool stalled = false;
+        for (std::size_t a = stall_arcs.begin(u); a < stall_arcs.end(u) && !stalled; ++a)
+            stalled = ws.dist(stall_arcs.node(a)) + stall_arcs.weight(a) < d;
+        if (stalled)
+            continue;
+        visit(u, d);
+
+        for (std::size_t a = arcs.begin(u); a < arcs.end(u); ++a)
+            ws.relax(u, arcs.node(a), d + arcs.weight(a));
+    }
+}
+
+// Forward and backward search state for repeated ch_query calls.
+struct ChQueryWorkspace
+{
+    explicit ChQueryWorkspace(const ContractionHierarchy &ch) : forward(ch.num_nodes(), 0), backward(ch.num_nodes(), 0)
+    {
+    }
+
+    QueryWorkspace<QuaternaryHeap> forward;
+    QueryWorkspace<QuaternaryHeap> backward;
+};
+
+// Bidirectional upward search. Both sides alternate single settle steps and
+// a side stops once its next key reaches the best meeting distance. Nodes
+// that a higher neighbour reaches more cheaply are stalled (stall-on-demand):
+// they cannot be on a shortest path, so their arcs are not relaxed.
+inline PathResult ch_query(const ContractionHierarchy &ch, int source, int target, ChQueryWorkspace &ws)
+{
+    PathResult result;
+
+    struct Side
+    {
+        const ChArcs &arcs;
+        const ChArcs &stall_arcs;
+        QueryWorkspace<QuaternaryHeap> &ws;
+        bool done = false;
+    };
+    Side sides[2] = {{ch.up(), ch.down(), ws.forward}, {ch.down(), ch.up(), ws.backward}};
+    for (int k = 0; k < 2; ++k)
+    {
+        int root = k == 0 ? source : target;
+        sides[k].ws.reset();
+        sides[k].ws.label(root, 0, -1);
+        sides[k].ws.queue().push_or_decrease(0, root);
+    }
+    long long best = DIST_INF;
+    int meet = -1;
+
+    for (int turn = 0; !(sides[0].done && sides[1].done); turn ^= 1)
+    {
+        Side &side = sides[turn];
+        const Side &other = sides[turn ^ 1];
+        auto &pq = side.ws.queue();
+        if (side.done)
+            continue;
+        if (pq.empty())
+        {
+            side.done = true;
+            continue;
+        }
+
+        auto [d, u] = pq.pop();
+        if (d >= best)
+        {
+            side.done = true;
+            continue;
+        }
+        ++result.settled;
+
+        if (other.ws.dist(u) < DIST_INF && d + other.ws.dist(u) < best)
+        {
+            best = d + other.ws.dist(u);
+            meet = u;
+        }
+
+        bool stalled = false;
+        for (std::size_t a = side.stall_arcs.begin(u); a < side.stall_arcs.end(u) && !stalled; ++a)
+            stalled = side.ws.dist(side.stall_arcs.node(a)) + side.stall_arcs.weight(a) < d;
+        if (stalled)
+            continue;
+
+        for (std::size_t a = side.arcs.begin(u); a < side.arcs.end(u); ++a)
+            side.ws.relax(u, side.arcs.node(a), d + side.arcs.weight(a));
+    }
+
+    if (meet == -1)
+        return result;
+
+    // Parent links are hierarchy arcs; each is unpacked into original nodes.
+    const auto &up = ch.up();
+    const auto &down = ch.down();
+    result.distance = best;
+    std::vector<int> up_chain;
+    for (int v = meet; v != source; v = ws.forward.parent(v))
+        up_chain.push_back(v);
+    result.path.push_back(source);
+    for (auto it = up_chain.rbegin(); it != up_chain.rend(); ++it)
+    {
+        int v = *it, p = ws.forward.parent(v);
+        ch_unpack(ch, p, v, up.middle(up.find(p, v)), result.path);
+    }
+    for (int v = meet; v != target; v = ws.backward.parent(v))
+    {
+        int p = ws.backward.parent(v);
+        ch_unpack(ch, v, p, down.middle(down.find(p, v)), result.path);
+    }
+    return result;
+}
+
+inline PathResult ch_query(const ContractionHierarchy &ch, int source, int target)
+{
+    ChQueryWorkspace ws(ch);
+    return ch_query(ch, source, target, ws);
+}
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "dijkstra.hpp"
+#include "graph.hpp"
+#include "heaps.hpp"
+
+// Compact adjacency for bandwidth-bound searches. Each node's arcs are sorted
+// by target and delta-encoded: the first target relative to the node itself
+// (zigzag-coded, since it may be negative), the others relative to the
+// previous target. A node's record is one byte giving the width of its
+// deltas (1-4 bytes, the widest one needs), then per arc the delta and the
+// weight, whose width (1-4 bytes) is fixed per graph by its max weight. With
+// widths fixed per node, decoding has no data-dependent branches. After a
+// locality ordering (--reorder) most nodes get 1-byte deltas. Byte offsets
+// are a 64-bit base per block of 256 nodes plus a 32-bit offset into the
+// block per node.
+class CompressedGraph
+{
+public:
+    static constexpr int BLOCK_SHIFT = 8;
+
+    CompressedGraph() = default;
+
+    // Fails (with a message) only if 256 consecutive nodes need more than
+    // 4 GiB of arc bytes.
+    static bool build(const CsrGraph &graph, CompressedGraph &out)
+    {
+        CompressedGraph c;
+        c.n_ = graph.num_nodes();
+        c.arcs_ = graph.num_edges();
+        c.max_weight_ = graph.max_weight();
+        c.weight_bytes_ = c.max_weight_ <= 0xff ? 1 : c.max_weight_ <= 0xffff ? 2 : c.max_weight_ <= 0xffffff ? 3 : 4;
+        c.weight_mask_ = mask(c.weight_bytes_);
+        c.rel_.resize(c.n_ + 2);
+        c.base_.resize(((c.n_ + 1) >> BLOCK_SHIFT) + 1);
+
+        auto &bytes = c.bytes_;
+        std::vector<std::pair<int, int>> arcs;
+        std::vector<std::uint32_t> deltas;
+        for (int u = 0; u <= c.n_ + 1; ++u)
+        {
+            if ((u & ((1 << BLOCK_SHIFT) - 1)) == 0)
+                c.base_[u >> BLOCK_SHIFT] = bytes.size();
+            std::uint64_t rel = bytes.size() - c.base_[u >> BLOCK_SHIFT];
+            if (rel > std::numeric_limits<std::uint32_t>::max())
+            {
+                std::cerr << "Cannot compress graph: arcs near node " << u << " exceed 4 GiB per block\n";
+                return false;
+            }
+            c.rel_[u] = (std::uint32_t)rel;
+            if (u == 0 || u > c.n_)
+                continue;
+
+            auto targets = graph.targets(u);
+            auto weights = graph.weights(u);
+            arcs.clear();
+            for (std::size_t i = 0; i < targets.size(); ++i)
+                arcs.push_back({targets[i], weights[i]});
+            std::sort(arcs.begin(), arcs.end());
+            if (arcs.empty())
+                continue;
+            c.max_degree_ = std::max(c.max_degree_, arcs.size());
+            // Every delta fits in 32 bits: targets are positive ints, and
+            // the zigzag code of the first one stays below 2^32.
+            deltas.clear();
+            long long prev = u;
+            std::uint32_t widest = 0;
+            for (const auto &[v, w] : arcs)
+            {
+                long long delta = v - prev;
+                deltas.push_back(deltas.empty() ? (std::uint32_t)zigzag(delta) : (std::uint32_t)delta);
+                widest |= deltas.back();
+                prev = v;
+            }
+            int delta_bytes = widest <= 0xff ? 1 : widest <= 0xffff ? 2 : widest <= 0xffffff ? 3 : 4;
+            bytes.push_back((std::uint8_t)delta_bytes);
+            for (std::size_t i = 0; i < arcs.size(); ++i)
+            {
+                c.put(deltas[i], delta_bytes);
+                c.put((std::uint32_t)arcs[i].second, c.weight_bytes_);
+            }
+        }
+        // Fields are read as 4-byte words and masked.
+        bytes.resize(bytes.size() + 3, 0);
+        out = std::move(c);
+        return true;
+    }
+
+    int num_nodes() const { return n_; }
+    std::size_t num_edges() const { return arcs_; }
+    int max_weight() const { return max_weight_; }
+    int weight_bytes() const { return weight_bytes_; }
+    std::size_t max_degree() const { return max_degree_; }
+
+    // Total size of the arrays, for comparison with csr_bytes().
+    std::size_t bytes() const
+    {
+        return bytes_.size() + rel_.size() * sizeof(rel_[0]) + base_.size() * sizeof(base_[0]);
+    }
+
+    // Writes the arcs of u, in target order, to targets and weights (room
+    // for max_degree() each) and returns their number.
+    std::size_t decode(int u, int *targets, int *weights) const
+    {
+        const std::uint8_t *p = bytes_.data() + offset(u);
+        const std::uint8_t *end = bytes_.data() + offset(u + 1);
+        if (p == end)
+            return 0;
+        int delta_bytes = *p++;
+        std::uint32_t delta_mask = mask(delta_bytes);
+        std::size_t stride = delta_bytes + weight_bytes_;
+        std::size_t k = (end - p) / stride;
+        long long v = u + unzigzag(load(p) & delta_mask);
+        for (std::size_t i = 0; i < k; ++i, p += stride)
+        {
+            if (i > 0)
+                v += load(p) & delta_mask;
+            targets[i] = (int)v;
+            weights[i] = (int)(load(p + delta_bytes) & weight_mask_);
+        }
+        return k;
+    }
+
+private:
+    std::uint64_t offset(int u) const { return base_[u >> BLOCK_SHIFT] + rel_[u]; }
+
+    static std::uint64_t zigzag(long long x) { return ((std::uint64_t)x << 1) ^ (std::uint64_t)(x >> 63); }
+    static long long unzigzag(std::uint32_t x) { return (long long)(x >> 1) ^ -(long long)(x & 1); }
+
+    static std::uint32_t mask(int bytes) { return bytes == 4 ? 0xffffffffu : (1u << (8 * bytes)) - 1; }
+
+    static std::uint32_t load(const std::uint8_t *p)
+    {
+        std::uint32_t x;
+        std::memcpy(&x, p, sizeof x);
+        return x;
+    }
+
+    void put(std::uint32_t x, int bytes)
+    {
+        for (int b = 0; b < bytes; ++b)
+            bytes_.push_back((std::uint8_t)(x >> (8 * b)));
+    }
+
+    int n_ = 0;
+    std::size_t arcs_ = 0;
+    std::size_t max_degree_ = 0;
+    int max_weight_ = 0;
+    int weight_bytes_ = 4;
+    std::uint32_t weight_mask_ = 0xffffffffu;
+    std::vector<std::uint8_t> bytes_;
+    std::vector<std::uint32_t> rel_;
+    std::vector<std::uint64_t> base_;
+};
+
+inline std::size_t csr_bytes(const CsrGraph &graph)
+{
+    return graph.offsets().size_bytes() + graph.all_targets().size_bytes() + graph.all_weights().size_bytes();
+}
+
+// dijkstra_sequential over the compressed adjacency. Each settled node's
+// arcs are decoded into the workspace's arc buffers and relaxed from there,
+// so hubs still take the vectorized scan.
+template <template <typename> class Queue, typename Dist>
+void dijkstra_compressed(const CompressedGraph &graph, int source, QueryWorkspace<Queue, Dist> &ws,
+                         std::span<const int> stop_at = {})
+{
+    TargetSet stop(stop_at, graph.num_nodes(), ws.target_marks());
+    ws.reset();
+    auto &pq = ws.queue();
+    auto &[targets, weights] = ws.arc_buffers();
+    if (targets.size() < graph.max_degree())
+    {
+        targets.resize(graph.max_degree());
+        weights.resize(graph.max_degree());
+    }
+
+    ws.label(source, 0, -1);
+    pq.push_or_decrease(0, source);
+
+    while (!pq.empty())
+    {
+        auto [d, u] = pq.pop();
+        if (d != ws.dist(u))
+        {
+            if constexpr (SEARCH_STATS_ENABLED)
+                ++ws.stats.stale_pops;
+            continue;
+        }
+        if (stop.settle(u))
+            break;
+        if constexpr (SEARCH_STATS_ENABLED)
+            ++ws.stats.settled;
+
+        std::size_t k = graph.decode(u, targets.data(), weights.data());
+        ws.relax_arcs(u, d, {targets.data(), k}, {weights.data(), k});
+    }
+}
+
+template <template <typename> class Queue = QuaternaryHeap>
+DijkstraResult dijkstra_compressed(const CompressedGraph &graph, int source, std::span<const int> stop_at = {},
+                                   bool track_parents = true)
+{
+    QueryWorkspace<Queue> ws(graph.num_nodes(), graph.max_weight(), track_parents);
+    dijkstra_compressed(graph, source, ws, stop_at);
+    return ws.release();
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+
+#include "dijkstra.hpp"
+#include "graph.hpp"
+#include "search_stats.hpp"
+
+// Bucket width heuristic from Meyer & Sanders: roughly the max weight over
+// the average degree, so a bucket holds about one hop of light arcs.
+inline long long default_delta(const CsrGraph &graph)
+{
+    if (graph.num_nodes() == 0 || graph.num_edges() == 0)
+        return 1;
+    double avg_degree = (double)graph.num_edges() / graph.num_nodes();
+    return std::max<long long>(1, (long long)(graph.max_weight() / std::max(1.0, avg_degree)));
+}
+
+// Parallel delta-stepping SSSP. Nodes are kept in buckets of width delta;
+// the current bucket is expanded over light arcs (weight <= delta) until it
+// stops refilling, then the heavy arcs of everything it settled are relaxed
+// once. Each phase generates relaxation requests on the TBB pool and applies
+// them with an atomic compare-and-swap min on dist. A request's parent is
+// only recorded when it set the final value of the phase, so parent arcs are
+// tight and point to nodes improved strictly earlier. With stop_at non-empty
+// the search ends after the bucket that settles the last listed node.
+inline DijkstraResult delta_stepping(const CsrGraph &graph, int source, long long delta,
+                                     std::span<const int> stop_at = {})
+{
+    int n = graph.num_nodes();
+    delta = std::max<long long>(1, delta);
+
+    std::vector<long long> dist(n + 1, DIST_INF);
+    std::vector<int> parent(n + 1, -1);
+
+    // Every queued distance lies within max_weight of the current bucket's
+    // start, so a ring of this many buckets never aliases two live buckets.
+    const std::size_t n_buckets = (std::size_t)(graph.max_weight() / delta) + 2;
+    std::vector<std::vector<int>> buckets(n_buckets);
+    std::size_t pending = 1;
+
+    // Phase markers for de-duplicating bucket entries.
+    std::vector<long long> in_frontier(n + 1, -1);
+    std::vector<long long> in_settled(n + 1, -1);
+
+    struct Request
+    {
+        int node;
+        int prev;
+        long long dist;
+        bool won;
+    };
+    tbb::enumerable_thread_specific<std::vector<Request>> requests;
+    tbb::enumerable_thread_specific<std::vector<int>> improved;
+    tbb::enumerable_thread_specific<SearchStats> local_stats;
+    SearchStats stats;
+
+    auto relax = [&]()
+    {
+        for (auto &local : requests)
+        {
+            tbb::parallel_for(tbb::blocked_range<std::size_t>(0, local.size()), [&](const auto &r)
+                              {
+                for (std::size_t i = r.begin(); i < r.end(); ++i)
+                {
+                    Request &req = local[i];
+                    std::atomic_ref<long long> slot(dist[req.node]);
+                    long long cur = slot.load(std::memory_order_relaxed);
+                    while (req.dist < cur)
+                    {
+                        if (slot.compare_exchange_weak(cur, req.dist, std::memory_order_relaxed))
+                        {
+                            req.won = true;
+                            break;
+                        }
+                        if constexpr (SEARCH_STATS_ENABLED)
+                            ++local_stats.local().cas_retries;
+                    }
+                } });
+        }
+
+        for (auto &local : requests)
+        {
+            tbb::parallel_for(tbb::blocked_range<std::size_t>(0, local.size()), [&](const auto &r)
+                              {
+                auto &out = improved.local();
+                for (std::size_t i = r.begin(); i < r.end(); ++i)
+                {
+                    const Request &req = local[i];
+                    if (req.won && req.dist == dist[req.node])
+                    {
+                        parent[req.node] = req.prev;
+                        out.push_back(req.node);
+                        if constexpr (SEARCH_STATS_ENABLED)
+                            ++local_stats.local().improvements;
+                    }
+                } });
+            local.clear();
+        }
+
+        for (auto &local : improved)
+        {
+            for (int v : local)
+                buckets[(std::size_t)(dist[v] / delta) % n_buckets].push_back(v);
+            pending += local.size();
+            local.clear();
+        }
+        if constexpr (SEARCH_STATS_ENABLED)
+        {
+            ++stats.phases;
+            stats.peak_queue = std::max<std::uint64_t>(stats.peak_queue, pending);
+        }
+    };
+
+    auto generate = [&](const std::vector<int> &nodes, bool light)
+    {
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, nodes.size()), [&](const auto &r)
+                          {
+            auto &out = requests.local();
+            for (std::size_t i = r.begin(); i < r.end(); ++i)
+            {
+                int u = nodes[i];
+                long long d = dist[u];
+                auto targets = graph.targets(u);
+                auto weights = graph.weights(u);
+                if constexpr (SEARCH_STATS_ENABLED)
+                    local_stats.local().arcs_scanned += targets.size();
+                for (std::size_t k = 0; k < targets.size(); ++k)
+                {
+                    if ((weights[k] <= delta) != light)
+                        continue;
+                    long long new_dist = d + weights[k];
+                    if (new_dist < dist[targets[k]])
+                        out.push_back({targets[k], u, new_dist, false});
+                }
+            } });
+    };
+
+    dist[source] = 0;
+    buckets[0].push_back(source);
+
+    std::vector<int> frontier;
+    std::vector<int> settled;
+    long long phase = 0;
+    for (long long b = 0; pending > 0; ++b)
+    {
+        auto &bucket = buckets[(std::size_t)b % n_buckets];
+        settled.clear();
+
+        while (!bucket.empty())
+        {
+            ++phase;
+            frontier.clear();
+            pending -= bucket.size();
+            for (int v : bucket)
+            {
+                if (dist[v] / delta != b || in_frontier[v] == phase)
+                {
+                    if constexpr (SEARCH_STATS_ENABLED)
+                        ++stats.stale_pops;
+                    continue;
+                }
+                in_frontier[v] = phase;
+                frontier.push_back(v);
+                if (in_settled[v] != b)
+                {
+                    in_settled[v] = b;
+                    settled.push_back(v);
+                }
+            }
+            bucket.clear();
+            if constexpr (SEARCH_STATS_ENABLED)
+                stats.settled += frontier.size();
+
+            generate(frontier, true);
+            relax();
+        }
+
+        generate(settled, false);
+        relax();
+
+        if (!stop_at.empty() && std::all_of(stop_at.begin(), stop_at.end(), [&](int t)
+                                            { return dist[t] / delta <= b; }))
+            break;
+    }
+
+    for (const auto &local : local_stats)
+        stats += local;
+    return {std::move(dist), std::move(parent), false, stats};
+}
@@ -0,0 +1,431 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+
+#include "graph.hpp"
+#include "heaps.hpp"
+#include "relax_tuning.hpp"
+#include "search_stats.hpp"
+#include "simd_relax.hpp"
+
+inline constexpr long long DIST_INF = std::numeric_limits<long long>::max() / 4;
+
+// Distance types for the searches below. long long keeps DIST_INF, whose
+// headroom means d + w can never wrap. Narrower integer types use their
+// maximum as infinity, so sums are formed in long long and checked against
+// it; a search that hits the limit sets its overflow flag.
+template <typename Dist>
+struct DistTraits
+{
+    static_assert(std::is_integral_v<Dist> && (sizeof(Dist) < sizeof(long long) || std::is_same_v<Dist, long long>),
+                  "distances must be long long or a narrower integer type");
+
+    static constexpr bool narrow = !std::is_same_v<Dist, long long>;
+    static constexpr Dist inf = narrow ? std::numeric_limits<Dist>::max() : (Dist)DIST_INF;
+};
+
+template <typename Dist>
+struct BasicDijkstraResult
+{
+    std::vector<Dist> dist;
+    // Empty when the search ran without parent tracking.
+    std::vector<int> parent;
+    // Some distance did not fit in Dist; nodes beyond it were left unreached.
+    bool overflow = false;
+    // All zero unless built with DIJKSTRA_STATS.
+    SearchStats stats;
+};
+
+using DijkstraResult = BasicDijkstraResult<long long>;
+
+// A single source-target answer: the distance (DIST_INF if unreachable), the
+// node sequence from source to target, and how many nodes the search settled
+// (0 when the engine does not count).
+struct PathResult
+{
+    long long distance = DIST_INF;
+    std::vector<int> path;
+    std::size_t settled = 0;
+};
+
+// The path is left empty when no parents were tracked.
+template <typename Dist>
+PathResult extract_path(std::span<const Dist> dist, std::span<const int> parent, int target)
+{
+    PathResult out;
+    if (dist[target] == DistTraits<Dist>::inf)
+        return out;
+    out.distance = (long long)dist[target];
+    if (parent.empty())
+        return out;
+    for (int v = target; v != -1; v = parent[v])
+        out.path.push_back(v);
+    std::reverse(out.path.begin(), out.path.end());
+    return out;
+}
+
+template <typename Dist>
+PathResult extract_path(const BasicDijkstraResult<Dist> &result, int target)
+{
+    return extract_path<Dist>(result.dist, result.parent, target);
+}
+
+// Early-exit bookkeeping for point-to-point and multi-target queries. An
+// empty target list never stops the search. Several targets are marked in a
+// caller-owned array of n + 1 zeros (sized on first use), which is zero
+// again once the set is destroyed.
+class TargetSet
+{
+public:
+    TargetSet(std::span<const int> targets, int n, std::vector<char> &marks) : targets_(targets), marks_(marks)
+    {
+        if (targets.size() <= 1)
+            return;
+        if (marks_.size() < (std::size_t)n + 1)
+            marks_.assign(n + 1, 0);
+        for (int t : targets)
+        {
+            if (!marks_[t])
+            {
+                marks_[t] = 1;
+                ++remaining_;
+            }
+        }
+    }
+
+    TargetSet(const TargetSet &) = delete;
+    TargetSet &operator=(const TargetSet &) = delete;
+
+    ~TargetSet()
+    {
+        if (remaining_ > 0)
+            for (int t : targets_)
+                marks_[t] = 0;
+    }
+
+    // Records that u was settled; true once every target is.
+    bool settle(int u)
+    {
+        if (targets_.size() <= 1)
+            return !targets_.empty() && u == targets_[0];
+        if (!marks_[u])
+            return false;
+        marks_[u] = 0;
+        return --remaining_ == 0;
+    }
+
+private:
+    std::span<const int> targets_;
+    std::vector<char> &marks_;
+    std::size_t remaining_ = 0;
+};
+
+// A candidate label found by the parallel scan of a hub's arcs.
+struct RelaxUpdate
+{
+    int node;
+    long long dist;
+    int prev;
+};
+
+// Per-thread buffers of the parallel relaxation branch. They live in the
+// query workspace, so after warm-up neither hub vertices nor new queries
+// allocate.
+struct ParallelRelaxBuffers
+{
+    tbb::enumerable_thread_specific<std::vector<RelaxUpdate>> updates;
+    tbb::enumerable_thread_specific<std::vector<std::uint32_t>> scratch;
+};
+
+// One node's arcs decoded from a format that does not store them as plain
+// arrays (compressed_graph.hpp).
+struct ArcBuffers
+{
+    std::vector<int> targets;
+    std::vector<int> weights;
+};
+
+// Per-query state that callers keep across queries on one graph: dist and
+// (optionally) parent arrays, the priority queue and the search temporaries.
+// Only entries written by the last query are reset, so a short query costs
+// O(touched) rather than O(n), and all storage is kept. Between queries
+// every dist entry is infinite and every parent -1.
+template <template <typename> class Queue = QuaternaryHeap, typename Dist = long long>
+class QueryWorkspace
+{
+public:
+    using Traits = DistTraits<Dist>;
+
+    explicit QueryWorkspace(const CsrGraph &graph, bool track_parents = true)
+        : QueryWorkspace(graph.num_nodes(), graph.max_weight(), track_parents)
+    {
+    }
+
+    QueryWorkspace(int n, int max_weight, bool track_parents = true)
+        : dist_(n + 1, Traits::inf), parent_(track_parents ? n + 1 : 0, -1), pq_(n, max_weight)
+    {
+    }
+
+    void reset()
+    {
+        for (int v : touched_)
+            dist_[v] = Traits::inf;
+        if (!parent_.empty())
+            for (int v : touched_)
+                parent_[v] = -1;
+        touched_.clear();
+        pq_.clear();
+        overflow = false;
+        stats = {};
+    }
+
+    Dist dist(int v) const { return dist_[v]; }
+    int parent(int v) const { return parent_[v]; }
+    std::span<const Dist> dist() const { return dist_; }
+    std::span<const int> parent() const { return parent_; }
+    std::size_t touched() const { return touched_.size(); }
+    bool tracks_parents() const { return !parent_.empty(); }
+
+    void label(int v, Dist d, int p)
+    {
+        if (dist_[v] == Traits::inf)
+            touched_.push_back(v);
+        dist_[v] = d;
+        if (!parent_.empty())
+            parent_[v] = p;
+    }
+
+    // Relaxes arc u -> v given the candidate distance formed in long long;
+    // true when v improved and was queued.
+    bool relax(int u, int v, long long new_dist)
+    {
+        if constexpr (Traits::narrow)
+        {
+            if (new_dist >= (long long)Traits::inf)
+            {
+                overflow = true;
+                return false;
+            }
+        }
+        if (!(new_dist < (long long)dist_[v]))
+            return false;
+        label(v, (Dist)new_dist, u);
+        pq_.push_or_decrease((Dist)new_dist, v);
+        if constexpr (SEARCH_STATS_ENABLED)
+        {
+            ++stats.improvements;
+            stats.peak_queue = std::max<std::uint64_t>(stats.peak_queue, pq_.size());
+        }
+        return true;
+    }
+
+    // Relaxes all arcs of u, settled at d. High-degree nodes with 64-bit
+    // labels go through the vectorized candidate scan.
+    void relax_arcs(int u, Dist d, std::span<const int> targets, std::span<const int> weights)
+    {
+        if constexpr (SEARCH_STATS_ENABLED)
+            stats.arcs_scanned += targets.size();
+        if constexpr (!Traits::narrow)
+        {
+            if (targets.size() >= SIMD_RELAX_MIN_DEGREE)
+            {
+                if (scratch_.size() < targets.size())
+                    scratch_.resize(targets.size());
+                std::size_t k = find_improving(targets.data(), weights.data(), targets.size(), d, dist_.data(),
+                                               scratch_.data());
+                for (std::size_t j = 0; j < k; ++j)
+                    relax(u, targets[scratch_[j]], d + weights[scratch_[j]]);
+                return;
+            }
+        }
+        for (std::size_t i = 0; i < targets.size(); ++i)
+            relax(u, targets[i], (long long)d + weights[i]);
+    }
+
+    Queue<Dist> &queue() { return pq_; }
+    std::vector<char> &target_marks() { return target_marks_; }
+    ParallelRelaxBuffers &parallel_buffers() { return parallel_; }
+    ArcBuffers &arc_buffers() { return arc_buffers_; }
+
+    // Hands the arrays to a one-shot caller; the workspace is unusable after.
+    BasicDijkstraResult<Dist> release() { return {std::move(dist_), std::move(parent_), overflow, stats}; }
+
+    bool overflow = false;
+    SearchStats stats;
+
+private:
+    std::vector<Dist> dist_;
+    std::vector<int> parent_;
+    std::vector<int> touched_;
+    std::vector<std::uint32_t> scratch_;
+    std::vector<char> target_marks_;
+    ParallelRelaxBuffers parallel_;
+    ArcBuffers arc_buffers_;
+    Queue<Dist> pq_;
+};
+
+// Runs in a reusable workspace (reset first). With stop_at non-empty the
+// search ends as soon as all listed nodes are settled; labels are then final
+// for every settled node (in particular the targets) and tentative elsewhere.
+template <template <typename> class Queue, typename Dist>
+void dijkstra_sequential(const CsrGraph &graph, int source, QueryWorkspace<Queue, Dist> &ws,
+                         std::span<const int> stop_at = {})
+{
+    TargetSet stop(stop_at, graph.num_nodes(), ws.target_marks());
+    ws.reset();
+    auto &pq = ws.queue();
+
+    ws.label(source, 0, -1);
+    pq.push_or_decrease(0, source);
+
+    while (!pq.empty())
+    {
+        auto [d, u] = pq.pop();
+
+        // Only the lazy queues yield stale entries.
+        if (d != ws.dist(u))
+        {
+            if constexpr (SEARCH_STATS_ENABLED)
+                ++ws.stats.stale_pops;
+            continue;
+        }
+        if (stop.settle(u))
+            break;
+        if constexpr (SEARCH_STATS_ENABLED)
+            ++ws.stats.settled;
+
+        ws.relax_arcs(u, d, graph.targets(u), graph.weights(u));
+    }
+}
+
+// dijkstra_sequential<Dist, Queue> runs with Dist-typed distances, e.g.
+// dijkstra_sequential<std::uint32_t>(graph, source) for 4-byte labels;
+// dijkstra_sequential<Queue> keeps long long.
+template <typename Dist, template <typename> class Queue = QuaternaryHeap>
+BasicDijkstraResult<Dist> dijkstra_sequential(const CsrGraph &graph, int source, std::span<const int> stop_at = {},
+                                              bool track_parents = true)
+{
+    QueryWorkspace<Queue, Dist> ws(graph, track_parents);
+    dijkstra_sequential(graph, source, ws, stop_at);
+    return ws.release();
+}
+
+template <template <typename> class Queue = QuaternaryHeap>
+DijkstraResult dijkstra_sequential(const CsrGraph &graph, int source, std::span<const int> stop_at = {},
+                                   bool track_parents = true)
+{
+    return dijkstra_sequential<long long, Queue>(graph, source, stop_at, track_parents);
+}
+
+template <template <typename> class Queue, typename Dist>
+void dijkstra_parallel(const CsrGraph &graph, int source, QueryWorkspace<Queue, Dist> &ws,
+                       std::span<const int> stop_at = {})
+{
+    const ParallelRelaxTuning &tuning = parallel_relax_tuning();
+    TargetSet stop(stop_at, graph.num_nodes(), ws.target_marks());
+    ws.reset();
+    auto &pq = ws.queue();
+
+    ws.label(source, 0, -1);
+    pq.push_or_decrease(0, source);
+
+    // The parallel scan only reads dist; all writes happen in the serial
+    // merge below, so no locking is needed.
+    auto &updates = ws.parallel_buffers().updates;
+    auto &scratch = ws.parallel_buffers().scratch;
+
+    while (!pq.empty())
+    {
+        auto [d, u] = pq.pop();
+
+        if (d != ws.dist(u))
+        {
+            if constexpr (SEARCH_STATS_ENABLED)
+                ++ws.stats.stale_pops;
+            continue;
+        }
+        if (stop.settle(u))
+            break;
+        if constexpr (SEARCH_STATS_ENABLED)
+            ++ws.stats.settled;
+
+        auto targets = graph.targets(u);
+        auto weights = graph.weights(u);
+        if (targets.empty())
+            continue;
+
+        if (targets.size() < tuning.threshold)
+        {
+            ws.relax_arcs(u, d, targets, weights);
+        }
+        else
+        {
+            tbb::parallel_for(tbb::blocked_range<std::size_t>(0, targets.size(), tuning.grain), [&](const auto &r)
+                              {
+                auto &local = updates.local();
+                if constexpr (!DistTraits<Dist>::narrow)
+                {
+                    auto &idx = scratch.local();
+                    idx.resize(r.size());
+                    std::size_t k = find_improving(targets.data() + r.begin(), weights.data() + r.begin(), r.size(),
+                                                   d, ws.dist().data(), idx.data());
+                    for (std::size_t j = 0; j < k; ++j)
+                    {
+                        std::size_t i = r.begin() + idx[j];
+                        local.push_back({targets[i], d + weights[i], u});
+                    }
+                }
+                else
+                {
+                    for (std::size_t i = r.begin(); i < r.end(); ++i)
+                    {
+                        long long new_dist = (long long)d + weights[i];
+                        if (new_dist < (long long)ws.dist(targets[i]))
+                            local.push_back({targets[i], new_dist, u});
+                    }
+                } });
+
+            if constexpr (SEARCH_STATS_ENABLED)
+            {
+                ++ws.stats.parallel_nodes;
+                ws.stats.arcs_scanned += targets.size();
+            }
+            for (auto &local : updates)
+            {
+                for (const auto &upd : local)
+                {
+                    [[maybe_unused]] bool improved = ws.relax(upd.prev, upd.node, upd.dist);
+                    if constexpr (SEARCH_STATS_ENABLED)
+                        ws.stats.merge_rejected += !improved;
+                }
+                local.clear();
+            }
+        }
+    }
+}
+
+template <typename Dist, template <typename> class Queue = QuaternaryHeap>
+BasicDijkstraResult<Dist> dijkstra_parallel(const CsrGraph &graph, int source, std::span<const int> stop_at = {},
+                                            bool track_parents = true)
+{
+    QueryWorkspace<Queue, Dist> ws(graph, track_parents);
+    dijkstra_parallel(graph, source, ws, stop_at);
+    return ws.release();
+}
+
+template <template <typename> class Queue = QuaternaryHeap>
+DijkstraResult dijkstra_parallel(const CsrGraph &graph, int source, std::span<const int> stop_at = {},
+                                 bool track_parents = true)
+{
+    return dijkstra_parallel<long long, Queue>(graph, source, stop_at, track_parents);
+}
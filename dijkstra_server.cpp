@@ -0,0 +1,184 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "ch.hpp"
+#include "graph_cache.hpp"
+#include "heaps.hpp"
+#include "parse_number.hpp"
+#include "server.hpp"
+#include "tree_cache.hpp"
+
+// Splits "[address:]port" into its parts; the port must be in 1..65535.
+bool parse_tcp_address(const std::string &tcp, std::string &host, int &port)
+{
+    host = "127.0.0.1";
+    std::string_view digits = tcp;
+    if (auto colon = tcp.rfind(':'); colon != std::string::npos)
+    {
+        host = tcp.substr(0, colon);
+        digits.remove_prefix(colon + 1);
+    }
+    auto [end, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), port);
+    return ec == std::errc() && end == digits.data() + digits.size() && port >= 1 && port <= 65535;
+}
+
+// Opens a listening socket: "[address:]port" for TCP (default address
+// 127.0.0.1) or, with unix_path set, a Unix domain socket. Returns -1 on
+// failure.
+int open_listener(const std::string &tcp, const std::string &unix_path)
+{
+    int fd;
+    if (!unix_path.empty())
+    {
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (fd < 0 || unix_path.size() >= sizeof addr.sun_path)
+            return -1;
+        std::strcpy(addr.sun_path, unix_path.c_str());
+        unlink(unix_path.c_str());
+        if (bind(fd, (sockaddr *)&addr, sizeof addr) != 0)
+            return -1;
+    }
+    else
+    {
+        std::string host;
+        int port = 0;
+        if (!parse_tcp_address(tcp, host, port))
+            return -1;
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((uint16_t)port);
+        if (fd < 0 || inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1)
+            return -1;
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one);
+        if (bind(fd, (sockaddr *)&addr, sizeof addr) != 0)
+            return -1;
+    }
+    if (listen(fd, 64) != 0)
+        return -1;
+    return fd;
+}
+
+// Loads the graph (and optionally its contraction hierarchy) once and then
+// answers shortest-path queries over stdin/stdout or a socket; see
+// server.hpp for the protocol.
+int main(int argc, char **argv)
+{
+    bool use_cache = true;
+    bool use_ch = false;
+    std::string ch_file;
+    std::string listen_on, unix_path;
+    double cache_mb = 0;
+    QueueKind queue = QueueKind::Auto;
+    std::vector<std::string> args;
+    bool bad_args = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--no-cache")
+            use_cache = false;
+        else if (arg == "--queue" && i + 1 < argc)
+            bad_args |= !parse_queue_kind(argv[++i], queue);
+        else if (arg == "--ch")
+            use_ch = true;
+        else if (arg == "--ch-file" && i + 1 < argc)
+        {
+            use_ch = true;
+            ch_file = argv[++i];
+        }
+        else if (arg == "--tree-cache" && i + 1 < argc)
+            bad_args |= !parse_number(argv[++i], cache_mb);
+        else if (arg == "--listen" && i + 1 < argc)
+        {
+            listen_on = argv[++i];
+            std::string host;
+            int port;
+            bad_args |= !parse_tcp_address(listen_on, host, port);
+        }
+        else if (arg == "--unix" && i + 1 < argc)
+            unix_path = argv[++i];
+        else
+            args.push_back(arg);
+    }
+    if (bad_args || args.size() != 1)
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--no-cache] [--queue auto|binary|dary|pairing|radix|dial] [--ch] [--ch-file path]"
+                     " [--tree-cache MB] [--listen [addr:]port | --unix path] <graph.gr|graph.csr>\n";
+        return 1;
+    }
+
+    // stdout is the reply stream in stdin mode, so all logging goes to stderr.
+    auto start = std::chrono::steady_clock::now();
+    CsrGraph graph;
+    int n_nodes = 0;
+    if (!load_graph(args[0], graph, n_nodes, nullptr, use_cache))
+        return 1;
+    ContractionHierarchy ch;
+    if (use_ch)
+        load_contraction_hierarchy(args[0], graph, ch_file, ch, std::cerr);
+    QueueKind kind = resolve_queue_kind(queue, graph.max_weight());
+    std::cerr << "Ready: " << n_nodes << " nodes, " << graph.num_edges() << " arcs, "
+              << (use_ch ? "contraction hierarchy" : queue_kind_name(kind)) << ", loaded in "
+              << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()
+              << " ms\n";
+
+    std::unique_ptr<SourceTreeCache> cache;
+    if (cache_mb > 0)
+        cache = std::make_unique<SourceTreeCache>((std::size_t)(cache_mb * 1024 * 1024));
+
+    return with_queue(kind, [&]<template <typename> class Q>()
+                      {
+        QueryServer<Q> server(graph, use_ch ? &ch : nullptr, cache.get());
+        if (listen_on.empty() && unix_path.empty())
+        {
+            LineChannel channel(STDIN_FILENO, STDOUT_FILENO);
+            serve_channel(server, channel);
+            return 0;
+        }
+
+        int listener = open_listener(listen_on, unix_path);
+        if (listener < 0)
+        {
+            std::cerr << "Could not listen on " << (unix_path.empty() ? listen_on : unix_path) << ": "
+                      << std::strerror(errno) << "\n";
+            return 1;
+        }
+        // A client hanging up mid-reply must not kill the server.
+        signal(SIGPIPE, SIG_IGN);
+        std::cerr << "Listening on " << (unix_path.empty() ? listen_on : unix_path) << "\n";
+        while (true)
+        {
+            int fd = accept(listener, nullptr, nullptr);
+            if (fd < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                std::cerr << "accept failed: " << std::strerror(errno) << "\n";
+                return 1;
+            }
+            std::thread([&server, fd]
+                        {
+                LineChannel channel(fd, fd);
+                serve_channel(server, channel);
+                close(fd); })
+                .detach();
+        } });
+}
@@ -0,0 +1,278 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <tbb/parallel_for.h>
+
+#include "graph.hpp"
+#include "mapped_file.hpp"
+
+struct LoadStats
+{
+    std::size_t bytes = 0;
+    std::size_t arcs = 0;
+    double seconds = 0.0;
+    bool cached = false;
+
+    double mb_per_s() const { return seconds > 0 ? bytes / (1024.0 * 1024.0) / seconds : 0.0; }
+    double arcs_per_s() const { return seconds > 0 ? arcs / seconds : 0.0; }
+};
+
+inline const char *skip_blanks(const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+        ++p;
+    return p;
+}
+
+// Parses an optionally signed decimal integer starting at p (after blanks).
+// Returns nullptr when no digits are found, or more than 18 of them (so the
+// value cannot overflow).
+inline const char *parse_long(const char *p, const char *end, long long &out)
+{
+    p = skip_blanks(p, end);
+    bool negative = false;
+    if (p < end && *p == '-')
+    {
+        negative = true;
+        ++p;
+    }
+    if (p == end || (unsigned)(*p - '0') > 9)
+        return nullptr;
+
+    long long value = 0;
+    const char *digits = p;
+    while (p < end && (unsigned)(*p - '0') <= 9)
+    {
+        if (p - digits == 18)
+            return nullptr;
+        value = value * 10 + (*p++ - '0');
+    }
+    out = negative ? -value : value;
+    return p;
+}
+
+// Line parser for one slice of a .gr file. Errors are recorded rather than
+// printed so slices can be parsed concurrently.
+class DimacsParser
+{
+public:
+    // Handles one line without its trailing newline.
+    bool parse_line(const char *p, const char *end)
+    {
+        const char *line = p;
+        p = skip_blanks(p, end);
+        if (p == end || *p == 'c')
+            return true;
+
+        if (*p == 'a')
+        {
+            long long u, v, w;
+            if (!(p = parse_long(p + 1, end, u)) || !(p = parse_long(p, end, v)) || !(p = parse_long(p, end, w)))
+                return fail(line, "Malformed arc line");
+            if (n_nodes < 0)
+                return fail(line, "Arc line before problem line");
+            if (u < 1 || u > n_nodes || v < 1 || v > n_nodes)
+                return fail(line, "Arc endpoint out of range");
+            if (w < 0 || w > std::numeric_limits<int>::max())
+                return fail(line, "Arc weight out of range");
+
+            arcs.sources.push_back((int)u);
+            arcs.targets.push_back((int)v);
+            arcs.weights.push_back((int)w);
+            return true;
+        }
+
+        if (*p == 'p')
+        {
+            if (n_nodes >= 0)
+                return fail(line, "Duplicate problem line");
+            p = skip_blanks(p + 1, end);
+            while (p < end && *p != ' ' && *p != '\t')
+                ++p;
+            long long n, m;
+            if (!(p = parse_long(p, end, n)) || !parse_long(p, end, m) || n < 0 || m < 0 ||
+                n > std::numeric_limits<int>::max() - 2)
+                return fail(line, "Malformed problem line");
+
+            n_nodes = (int)n;
+            n_arcs = m;
+            return true;
+        }
+
+        return true;
+    }
+
+    // Handles every line in [p, end); a missing final newline is fine. With
+    // stop_at_problem set, returns right after the problem line. Returns
+    // nullptr on error.
+    const char *parse_lines(const char *p, const char *end, bool stop_at_problem = false)
+    {
+        while (p < end)
+        {
+            const char *nl = (const char *)std::memchr(p, '\n', end - p);
+            const char *line_end = nl ? nl : end;
+            if (!parse_line(p, line_end))
+                return nullptr;
+            p = nl ? nl + 1 : end;
+            if (stop_at_problem && n_nodes >= 0)
+                break;
+        }
+        return p;
+    }
+
+    void reserve(std::size_t arcs_expected)
+    {
+        arcs.sources.reserve(arcs_expected);
+        arcs.targets.reserve(arcs_expected);
+        arcs.weights.reserve(arcs_expected);
+    }
+
+    int n_nodes = -1;
+    long long n_arcs = 0;
+    ArcBuffer arcs;
+
+    const char *error = nullptr;
+    const char *error_pos = nullptr;
+
+private:
+    bool fail(const char *pos, const char *what)
+    {
+        error = what;
+        error_pos = pos;
+        return false;
+    }
+};
+
+// Reads a DIMACS .gr file. The file is mapped, the problem line is located
+// serially, and the arc section is split into newline-aligned chunks parsed
+// concurrently on the TBB pool. The per-chunk arc buffers are merged into
+// CSR by build_csr's parallel counting sort.
+inline bool read_dimacs_gr(const std::string &filename, CsrGraph &graph, int &n_nodes, LoadStats *stats = nullptr)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    auto file = map_file(filename);
+    if (!file)
+    {
+        std::cerr << "Could not open file " << filename << "\n";
+        return false;
+    }
+    file->advise(MADV_SEQUENTIAL);
+
+    const char *begin = file->data();
+    const char *end = begin + file->size();
+    auto report = [&](const DimacsParser &parser)
+    {
+        std::size_t line = 1 + std::count(begin, parser.error_pos, '\n');
+        std::cerr << parser.error << " in " << filename << " at line " << line << "\n";
+        return false;
+    };
+
+    DimacsParser header;
+    const char *body = header.parse_lines(begin, end, true);
+    if (!body)
+        return report(header);
+    n_nodes = header.n_nodes < 0 ? 0 : header.n_nodes;
+
+    const std::size_t CHUNK = std::size_t(8) << 20;
+    const std::size_t body_bytes = end - body;
+    const std::size_t n_chunks = std::max<std::size_t>(1, body_bytes / CHUNK);
+
+    std::vector<const char *> bounds(n_chunks + 1, end);
+    bounds[0] = body;
+    for (std::size_t c = 1; c < n_chunks; ++c)
+    {
+        const char *p = std::max(bounds[c - 1], body + c * (body_bytes / n_chunks));
+        const char *nl = (const char *)std::memchr(p, '\n', end - p);
+        bounds[c] = nl ? nl + 1 : end;
+    }
+
+    std::vector<DimacsParser> parsers(n_chunks);
+    tbb::parallel_for(std::size_t(0), n_chunks, [&](std::size_t c)
+                      {
+        auto &parser = parsers[c];
+        parser.n_nodes = header.n_nodes;
+        // The header's arc count is untrusted; no slice holds more arcs than
+        // it has shortest lines ("a 1 1 0\n").
+        std::size_t slice_bytes = bounds[c + 1] - bounds[c];
+        double share = body_bytes ? (double)slice_bytes / body_bytes : 0.0;
+        parser.reserve(std::min<std::size_t>(header.n_arcs * share * 1.05, slice_bytes / 8 + 1));
+        parser.parse_lines(bounds[c], bounds[c + 1]); });
+
+    std::vector<ArcBuffer> buffers;
+    buffers.reserve(n_chunks);
+    std::size_t arcs = 0;
+    for (auto &parser : parsers)
+    {
+        if (parser.error)
+            return report(parser);
+        arcs += parser.arcs.size();
+        buffers.push_back(std::move(parser.arcs));
+    }
+    parsers.clear();
+
+    graph = build_csr(n_nodes, std::move(buffers));
+
+    if (stats)
+    {
+        stats->bytes = file->size();
+        stats->arcs = arcs;
+        stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return true;
+}
+
+struct Coord
+{
+    int x;
+    int y;
+};
+
+// Reads a DIMACS .co coordinate file ("v id x y" lines) for a graph with
+// n_nodes nodes. coords has n_nodes + 1 entries; nodes without a "v" line
+// keep (0, 0).
+inline bool read_dimacs_co(const std::string &filename, int n_nodes, std::vector<Coord> &coords)
+{
+    auto file = map_file(filename);
+    if (!file)
+    {
+        std::cerr << "Could not open file " << filename << "\n";
+        return false;
+    }
+    file->advise(MADV_SEQUENTIAL);
+
+    coords.assign(n_nodes + 1, {0, 0});
+    const char *p = file->data();
+    const char *end = p + file->size();
+    std::size_t line_no = 0;
+    while (p < end)
+    {
+        const char *nl = (const char *)std::memchr(p, '\n', end - p);
+        const char *line_end = nl ? nl : end;
+        ++line_no;
+
+        const char *q = skip_blanks(p, line_end);
+        if (q < line_end && *q == 'v')
+        {
+            long long id, x, y;
+            if (!(q = parse_long(q + 1, line_end, id)) || !(q = parse_long(q, line_end, x)) ||
+                !parse_long(q, line_end, y) || id < 1 || id > n_nodes || x < std::numeric_limits<int>::min() ||
+                x > std::numeric_limits<int>::max() || y < std::numeric_limits<int>::min() ||
+                y > std::numeric_limits<int>::max())
+            {
+                std::cerr << "Malformed coordinate line in " << filename << " at line " << line_no << "\n";
+                return false;
+            }
+            coords[id] = {(int)x, (int)y};
+        }
+        p = nl ? nl + 1 : end;
+    }
+    return true;
+}
@@ -0,0 +1,86 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ch.hpp"
+#include "graph_cache.hpp"
+#include "heaps.hpp"
+#include "matrix.hpp"
+
+// Computes a sources x targets distance table and writes it in the dense
+// binary format of write_distance_matrix.
+int main(int argc, char **argv)
+{
+    bool use_cache = true;
+    bool use_ch = false;
+    std::string ch_file;
+    QueueKind queue = QueueKind::Auto;
+    std::vector<std::string> args;
+    bool bad_args = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--no-cache")
+            use_cache = false;
+        else if (arg == "--queue" && i + 1 < argc)
+            bad_args |= !parse_queue_kind(argv[++i], queue);
+        else if (arg == "--ch")
+            use_ch = true;
+        else if (arg == "--ch-file" && i + 1 < argc)
+        {
+            use_ch = true;
+            ch_file = argv[++i];
+        }
+        else
+            args.push_back(arg);
+    }
+    if (bad_args || args.size() != 4)
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--no-cache] [--queue auto|binary|dary|pairing|radix|dial] [--ch] [--ch-file path]"
+                     " <graph.gr|graph.csr> <sources.txt> <targets.txt> <matrix.bin>\n";
+        return 1;
+    }
+
+    CsrGraph graph;
+    int n_nodes = 0;
+    if (!load_graph(args[0], graph, n_nodes, nullptr, use_cache))
+        return 1;
+
+    std::vector<int> sources, targets;
+    for (int k = 0; k < 2; ++k)
+    {
+        std::ifstream in(args[1 + k]);
+        if (!in)
+        {
+            std::cerr << "Could not open file " << args[1 + k] << "\n";
+            return 1;
+        }
+        if (!read_node_list(in, n_nodes, k == 0 ? sources : targets))
+            return 1;
+    }
+    std::cout << "Graph: " << n_nodes << " nodes, " << graph.num_edges() << " arcs; " << sources.size()
+              << " sources x " << targets.size() << " targets\n";
+
+    ContractionHierarchy ch;
+    if (use_ch)
+        load_contraction_hierarchy(args[0], graph, ch_file, ch, std::cout);
+
+    auto start = std::chrono::steady_clock::now();
+    DistanceMatrix matrix;
+    if (use_ch)
+        matrix = ch_distance_matrix(ch, std::move(sources), std::move(targets));
+    else
+        matrix = with_queue(resolve_queue_kind(queue, graph.max_weight()), [&]<template <typename> class Q>()
+                            { return distance_matrix<Q>(graph, std::move(sources), std::move(targets)); });
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Computed " << matrix.dist.size() << " distances in " << ms << " ms"
+              << (use_ch ? " (contraction hierarchy buckets)" : "") << "\n";
+
+    if (!write_distance_matrix(args[3], matrix))
+        return 1;
+    std::cout << "Wrote " << args[3] << "\n";
+    return 0;
+}
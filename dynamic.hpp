@@ -0,0 +1,322 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <span>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "dijkstra.hpp"
+#include "graph.hpp"
+#include "heaps.hpp"
+
+// New weight for every arc from -> to (parallel arcs all get it).
+struct WeightChange
+{
+    int from;
+    int to;
+    int weight;
+};
+
+// One arc whose weight actually changed.
+struct ArcChange
+{
+    int from;
+    int to;
+    int old_weight;
+    int new_weight;
+};
+
+// Reads "from to weight" lines; blank lines and lines starting with '#' are
+// skipped.
+inline bool read_weight_changes(std::istream &in, int n_nodes, std::vector<WeightChange> &changes)
+{
+    std::string line;
+    std::size_t line_no = 0;
+    while (std::getline(in, line))
+    {
+        ++line_no;
+        std::size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#')
+            continue;
+
+        std::istringstream ss(line);
+        long long u, v, w;
+        if (!(ss >> u >> v >> w) || u < 1 || u > n_nodes || v < 1 || v > n_nodes || w < 0 ||
+            w > std::numeric_limits<int>::max())
+        {
+            std::cerr << "Invalid weight change at line " << line_no << ": " << line << "\n";
+            return false;
+        }
+        changes.push_back({(int)u, (int)v, (int)w});
+    }
+    return true;
+}
+
+// A graph whose arc weights can change in place. Topology is shared with the
+// CsrGraph it was made from; the weights are a private copy, and an index of
+// in-arcs (tail plus forward arc position) serves the repairs below.
+class DynamicGraph
+{
+public:
+    explicit DynamicGraph(const CsrGraph &graph)
+        : base_(graph), weights_(std::make_shared<std::vector<int>>(graph.all_weights().begin(),
+                                                                    graph.all_weights().end())),
+          max_weight_(graph.max_weight())
+    {
+        const int n = graph.num_nodes();
+        in_offsets_.assign(n + 2, 0);
+        for (int v : graph.all_targets())
+            ++in_offsets_[v + 1];
+        for (int v = 1; v <= n + 1; ++v)
+            in_offsets_[v] += in_offsets_[v - 1];
+        in_sources_.resize(graph.num_edges());
+        in_arcs_.resize(graph.num_edges());
+        std::vector<std::uint64_t> cursor(in_offsets_.begin(), in_offsets_.end() - 1);
+        for (int u = 1; u <= n; ++u)
+        {
+            for (std::uint64_t a = graph.offsets()[u]; a < graph.offsets()[u + 1]; ++a)
+            {
+                std::uint64_t pos = cursor[graph.all_targets()[a]]++;
+                in_sources_[pos] = u;
+                in_arcs_[pos] = a;
+            }
+        }
+    }
+
+    int num_nodes() const { return base_.num_nodes(); }
+    std::span<const int> targets(int u) const { return base_.targets(u); }
+    std::span<const int> weights(int u) const
+    {
+        return std::span<const int>(*weights_).subspan(base_.offsets()[u], base_.degree(u));
+    }
+    int weight(std::uint64_t arc) const { return (*weights_)[arc]; }
+
+    // In-arcs of v: the tail of each and the arc's index for weight().
+    std::span<const int> in_sources(int v) const { return {in_sources_.data() + in_offsets_[v], in_degree(v)}; }
+    std::span<const std::uint64_t> in_arcs(int v) const { return {in_arcs_.data() + in_offsets_[v], in_degree(v)}; }
+
+    // Applies changes and returns the arcs whose weight differs from before.
+    // Pairs without an arc are ignored.
+    std::vector<ArcChange> apply(std::span<const WeightChange> changes)
+    {
+        std::vector<ArcChange> applied;
+        for (const auto &c : changes)
+        {
+            auto targets = base_.targets(c.from);
+            for (std::size_t i = 0; i < targets.size(); ++i)
+            {
+                int &w = (*weights_)[base_.offsets()[c.from] + i];
+                if (targets[i] != c.to || w == c.weight)
+                    continue;
+                applied.push_back({c.from, c.to, w, c.weight});
+                w = c.weight;
+                max_weight_ = std::max(max_weight_, c.weight);
+            }
+        }
+        return applied;
+    }
+
+    // A CsrGraph over the current weights for the other algorithms. It sees
+    // later changes too; its max_weight stays an upper bound.
+    CsrGraph graph() const
+    {
+        return CsrGraph(base_.offsets(), base_.all_targets(), *weights_, weights_, max_weight_);
+    }
+
+private:
+    std::size_t in_degree(int v) const { return in_offsets_[v + 1] - in_offsets_[v]; }
+
+    CsrGraph base_;
+    std::shared_ptr<std::vector<int>> weights_;
+    int max_weight_;
+    std::vector<std::uint64_t> in_offsets_;
+    std::vector<int> in_sources_;
+    std::vector<std::uint64_t> in_arcs_;
+};
+
+struct RepairStats
+{
+    // Nodes whose tree path used an arc that got heavier.
+    std::size_t invalidated = 0;
+    // Nodes settled again by the repair search.
+    std::size_t settled = 0;
+    std::size_t arcs_scanned = 0;
+};
+
+// A shortest-path tree from one source kept up to date under weight changes
+// (Ramalingam-Reps). Heavier tree arcs invalidate the subtree below them:
+// those labels are cleared and re-seeded from their untouched in-neighbours.
+// Lighter arcs seed their head directly. A Dijkstra search from the seeds
+// then fixes all labels, so a repair costs time in the changed region; child
+// lists keep subtree walks from scanning the whole tree.
+class DynamicShortestPaths
+{
+public:
+    DynamicShortestPaths(const DynamicGraph &graph, int source)
+        : DynamicShortestPaths(graph, source, dijkstra_sequential(graph.graph(), source))
+    {
+    }
+
+    // Adopts a complete result (full search with parents) from source.
+    DynamicShortestPaths(const DynamicGraph &graph, int source, DijkstraResult result)
+        : source_(source), dist_(std::move(result.dist)), parent_(std::move(result.parent)),
+          first_child_(dist_.size(), -1), next_sibling_(dist_.size(), -1), prev_sibling_(dist_.size(), -1),
+          mark_(dist_.size(), 0), pq_(graph.num_nodes())
+    {
+        for (int v = 1; v < (int)dist_.size(); ++v)
+            if (parent_[v] != -1)
+                link(v, parent_[v]);
+    }
+
+    int source() const { return source_; }
+    long long dist(int v) const { return dist_[v]; }
+    std::span<const long long> dist() const { return dist_; }
+    std::span<const int> parent() const { return parent_; }
+
+    // Repairs the tree after graph.apply() returned changes.
+    RepairStats repair(const DynamicGraph &graph, std::span<const ArcChange> changes)
+    {
+        RepairStats stats;
+        if (++epoch_ == 0)
+        {
+            std::fill(mark_.begin(), mark_.end(), 0);
+            epoch_ = 1;
+        }
+
+        // Heavier arcs: a tree arc that is no longer tight cuts off its
+        // subtree, unless a parallel arc still carries the old distance.
+        std::vector<int> invalid;
+        for (const auto &c : changes)
+        {
+            int v = c.to;
+            if (c.new_weight <= c.old_weight || parent_[v] != c.from || mark_[v] == epoch_ ||
+                tight(graph, c.from, v))
+                continue;
+            collect_subtree(v, invalid);
+        }
+        stats.invalidated = invalid.size();
+        for (int v : invalid)
+        {
+            unlink(v);
+            parent_[v] = -1;
+            dist_[v] = DIST_INF;
+        }
+        for (int v : invalid)
+        {
+            auto sources = graph.in_sources(v);
+            auto arcs = graph.in_arcs(v);
+            stats.arcs_scanned += sources.size();
+            for (std::size_t i = 0; i < sources.size(); ++i)
+            {
+                int u = sources[i];
+                if (mark_[u] != epoch_ && dist_[u] < DIST_INF)
+                    relax(u, v, dist_[u] + graph.weight(arcs[i]));
+            }
+        }
+
+        // Lighter arcs.
+        for (const auto &c : changes)
+            if (c.new_weight < c.old_weight && dist_[c.from] < DIST_INF)
+                relax(c.from, c.to, dist_[c.from] + c.new_weight);
+
+        while (!pq_.empty())
+        {
+            auto [d, u] = pq_.pop();
+            if (d != dist_[u])
+                continue;
+            ++stats.settled;
+            auto targets = graph.targets(u);
+            auto weights = graph.weights(u);
+            stats.arcs_scanned += targets.size();
+            for (std::size_t i = 0; i < targets.size(); ++i)
+                relax(u, targets[i], d + weights[i]);
+        }
+        return stats;
+    }
+
+    DijkstraResult result() const
+    {
+        DijkstraResult r;
+        r.dist = dist_;
+        r.parent = parent_;
+        return r;
+    }
+
+private:
+    bool tight(const DynamicGraph &graph, int u, int v) const
+    {
+        auto targets = graph.targets(u);
+        auto weights = graph.weights(u);
+        for (std::size_t i = 0; i < targets.size(); ++i)
+            if (targets[i] == v && dist_[u] + weights[i] == dist_[v])
+                return true;
+        return false;
+    }
+
+    void relax(int u, int v, long long new_dist)
+    {
+        if (!(new_dist < dist_[v]))
+            return;
+        dist_[v] = new_dist;
+        if (parent_[v] != -1)
+            unlink(v);
+        parent_[v] = u;
+        link(v, u);
+        pq_.push_or_decrease(new_dist, v);
+    }
+
+    // Appends the not yet marked part of root's subtree to out and marks it.
+    void collect_subtree(int root, std::vector<int> &out)
+    {
+        std::size_t begin = out.size();
+        mark_[root] = epoch_;
+        out.push_back(root);
+        for (std::size_t i = begin; i < out.size(); ++i)
+        {
+            for (int c = first_child_[out[i]]; c != -1; c = next_sibling_[c])
+            {
+                if (mark_[c] == epoch_)
+                    continue;
+                mark_[c] = epoch_;
+                out.push_back(c);
+            }
+        }
+    }
+
+    void link(int v, int p)
+    {
+        prev_sibling_[v] = -1;
+        next_sibling_[v] = first_child_[p];
+        if (first_child_[p] != -1)
+            prev_sibling_[first_child_[p]] = v;
+        first_child_[p] = v;
+    }
+
+    void unlink(int v)
+    {
+        int p = parent_[v];
+        if (prev_sibling_[v] != -1)
+            next_sibling_[prev_sibling_[v]] = next_sibling_[v];
+        else
+            first_child_[p] = next_sibling_[v];
+        if (next_sibling_[v] != -1)
+            prev_sibling_[next_sibling_[v]] = prev_sibling_[v];
+        prev_sibling_[v] = next_sibling_[v] = -1;
+    }
+
+    int source_;
+    std::vector<long long> dist_;
+    std::vector<int> parent_;
+    std::vector<int> first_child_;
+    std::vector<int> next_sibling_;
+    std::vector<int> prev_sibling_;
+    std::vector<std::uint32_t> mark_;
+    std::uint32_t epoch_ = 0;
+    QuaternaryHeap<long long> pq_;
+};
@@ -134,6 +134,7 @@ Examples:
     parser.add_argument('--edges-per-node', type=float, default=5, help='Edges per node (for custom)')
     parser.add_argument('--max-weight', type=int, default=100, help='Maximum edge weight')
     parser.add_argument('--output-dir', default='.', help='Output directory for graphs')
+    parser.add_argument('--seed', type=int, default=None, help='Random seed for reproducible graphs')
     
     args = parser.parse_args()
     
@@ -141,6 +142,9 @@ Examples:
         parser.print_help()
         return
     
+    if args.seed is not None:
+        random.seed(args.seed)
+
     print("=" * 70)
     print("DIJKSTRA GRAPH GENERATOR")
     print("=" * 70)
@@ -0,0 +1,415 @@
+#include <cuda_runtime.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gpu_sssp.hpp"
+
+// Near-far SSSP on the device; see gpu_sssp.hpp. Every array below holds one
+// row of n + 1 entries per batch slot, and kernels take the slot from
+// blockIdx.y. The host drives the phases and reads the per-slot counters
+// between launches.
+
+using gpu_dist = unsigned long long;
+
+static constexpr gpu_dist GPU_INF = (gpu_dist)GPU_DIST_INF;
+static constexpr int GPU_THREADS = 256;
+static constexpr int GPU_MAX_BATCH = 64;
+
+struct GpuGraphView
+{
+    const gpu_dist *offsets;
+    const int *targets;
+    const int *weights;
+};
+
+// Per-slot control block. near/next frontiers are shared buffers swapped by
+// the host for all slots at once; far piles flip per slot.
+struct GpuSlot
+{
+    gpu_dist threshold;
+    gpu_dist prev_threshold;
+    // Smallest distance pushed to the far pile since the last split.
+    gpu_dist far_min;
+    int phase;
+    int far_parity;
+    int near_count;
+    int next_count;
+    int far_count;
+    int far_next_count;
+    int splitting;
+};
+
+struct GpuBuffers
+{
+    gpu_dist *dist;
+    int *parent;
+    int *near_stamp;
+    int *far_stamp;
+    int *near;
+    int *next;
+    int *far[2];
+};
+
+__global__ void gpu_init(GpuBuffers buf, std::size_t total)
+{
+    for (std::size_t i = blockIdx.x * (std::size_t)blockDim.x + threadIdx.x; i < total;
+         i += (std::size_t)gridDim.x * blockDim.x)
+    {
+        buf.dist[i] = GPU_INF;
+        buf.parent[i] = -1;
+        buf.near_stamp[i] = -1;
+        buf.far_stamp[i] = -1;
+    }
+}
+
+__global__ void gpu_seed(GpuBuffers buf, GpuSlot *slots, const int *sources, int count, std::size_t n1,
+                         gpu_dist delta)
+{
+    int b = blockIdx.x * blockDim.x + threadIdx.x;
+    if (b >= count)
+        return;
+    std::size_t base = b * n1;
+    int s = sources[b];
+    buf.dist[base + s] = 0;
+    buf.near[base] = s;
+    GpuSlot slot{};
+    slot.threshold = delta;
+    slot.prev_threshold = 0;
+    slot.far_min = GPU_INF;
+    slot.near_count = 1;
+    slots[b] = slot;
+}
+
+// Relaxes the near frontier of every slot. Improved nodes below the
+// threshold go to the next frontier, the others to the far pile; stamps keep
+// one copy per frontier and per far phase.
+__global__ void gpu_relax(GpuGraphView g, GpuBuffers buf, GpuSlot *slots, std::size_t n1, int iteration)
+{
+    GpuSlot &slot = slots[blockIdx.y];
+    std::size_t base = blockIdx.y * n1;
+    gpu_dist *dist = buf.dist + base;
+    const int *near = buf.near + base;
+    int *next = buf.next + base;
+    int *far = buf.far[slot.far_parity] + base;
+    int *near_stamp = buf.near_stamp + base;
+    int *far_stamp = buf.far_stamp + base;
+    const gpu_dist threshold = slot.threshold;
+    const int phase = slot.phase;
+
+    for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < slot.near_count; i += gridDim.x * blockDim.x)
+    {
+        int u = near[i];
+        gpu_dist d = dist[u];
+        for (gpu_dist a = g.offsets[u]; a < g.offsets[u + 1]; ++a)
+        {
+            int v = g.targets[a];
+            gpu_dist nd = d + (gpu_dist)g.weights[a];
+            if (nd >= dist[v] || nd >= atomicMin(&dist[v], nd))
+                continue;
+            if (nd < threshold)
+            {
+                if (atomicExch(&near_stamp[v], iteration) != iteration)
+                    next[atomicAdd(&slot.next_count, 1)] = v;
+            }
+            else
+            {
+                atomicMin(&slot.far_min, nd);
+                if (atomicExch(&far_stamp[v], phase) != phase)
+                    far[atomicAdd(&slot.far_count, 1)] = v;
+            }
+        }
+    }
+}
+
+// Splits the far pile of slots flagged by the host: entries settled below
+// the previous threshold are dropped, those below the new one become the near
+// frontier, and the rest move to the other far buffer.
+__global__ void gpu_split(GpuBuffers buf, GpuSlot *slots, std::size_t n1, int stamp)
+{
+    GpuSlot &slot = slots[blockIdx.y];
+    if (!slot.splitting)
+        return;
+    std::size_t base = blockIdx.y * n1;
+    const gpu_dist *dist = buf.dist + base;
+    const int *far = buf.far[slot.far_parity] + base;
+    int *far_next = buf.far[slot.far_parity ^ 1] + base;
+    int *near = buf.near + base;
+    int *near_stamp = buf.near_stamp + base;
+    int *far_stamp = buf.far_stamp + base;
+
+    for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < slot.far_count; i += gridDim.x * blockDim.x)
+    {
+        int v = far[i];
+        gpu_dist d = dist[v];
+        if (d < slot.prev_threshold)
+            continue;
+        if (d < slot.threshold)
+        {
+            if (atomicExch(&near_stamp[v], stamp) != stamp)
+                near[atomicAdd(&slot.near_count, 1)] = v;
+        }
+        else if (atomicExch(&far_stamp[v], slot.phase) != slot.phase)
+        {
+            atomicMin(&slot.far_min, d);
+            far_next[atomicAdd(&slot.far_next_count, 1)] = v;
+        }
+    }
+}
+
+// One level of the parent pass: the first tight arc to reach a node claims
+// it, and the node joins the next level.
+__global__ void gpu_tree(GpuGraphView g, GpuBuffers buf, GpuSlot *slots, std::size_t n1)
+{
+    GpuSlot &slot = slots[blockIdx.y];
+    std::size_t base = blockIdx.y * n1;
+    const gpu_dist *dist = buf.dist + base;
+    int *parent = buf.parent + base;
+    const int *near = buf.near + base;
+    int *next = buf.next + base;
+
+    for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < slot.near_count; i += gridDim.x * blockDim.x)
+    {
+        int u = near[i];
+        gpu_dist d = dist[u];
+        for (gpu_dist a = g.offsets[u]; a < g.offsets[u + 1]; ++a)
+        {
+            int v = g.targets[a];
+            if (d + (gpu_dist)g.weights[a] == dist[v] && atomicCAS(&parent[v], -1, u) == -1)
+                next[atomicAdd(&slot.next_count, 1)] = v;
+        }
+    }
+}
+
+struct GpuSssp::Device
+{
+    std::string error;
+    std::string name;
+    int n = 0;
+    std::size_t n1 = 0;
+    int batch = 0;
+    GpuGraphView graph{};
+    GpuBuffers buf{};
+    GpuSlot *slots = nullptr;
+    int *sources = nullptr;
+    std::vector<void *> allocations;
+
+    bool check(cudaError_t status)
+    {
+        if (status == cudaSuccess)
+            return true;
+        error = cudaGetErrorString(status);
+        return false;
+    }
+
+    template <typename T>
+    bool alloc(T *&ptr, std::size_t count)
+    {
+        void *p = nullptr;
+        if (!check(cudaMalloc(&p, std::max<std::size_t>(1, count) * sizeof(T))))
+            return false;
+        allocations.push_back(p);
+        ptr = (T *)p;
+        return true;
+    }
+
+    ~Device()
+    {
+        for (void *p : allocations)
+            cudaFree(p);
+    }
+};
+
+GpuSssp::GpuSssp(int n, const std::uint64_t *offsets, const int *targets, const int *weights, std::size_t arcs)
+    : device_(std::make_unique<Device>())
+{
+    static_assert(sizeof(gpu_dist) == sizeof(std::uint64_t), "offsets are copied as-is");
+    Device &dev = *device_;
+    dev.n = n;
+    dev.n1 = (std::size_t)n + 1;
+
+    cudaDeviceProp prop;
+    if (!dev.check(cudaGetDeviceProperties(&prop, 0)) || !dev.check(cudaSetDevice(0)))
+        return;
+    dev.name = prop.name;
+
+    gpu_dist *d_offsets;
+    int *d_targets, *d_weights;
+    if (!dev.alloc(d_offsets, n + 2) || !dev.alloc(d_targets, arcs) || !dev.alloc(d_weights, arcs) ||
+        !dev.check(cudaMemcpy(d_offsets, offsets, (n + 2) * sizeof(gpu_dist), cudaMemcpyHostToDevice)) ||
+        !dev.check(cudaMemcpy(d_targets, targets, arcs * sizeof(int), cudaMemcpyHostToDevice)) ||
+        !dev.check(cudaMemcpy(d_weights, weights, arcs * sizeof(int), cudaMemcpyHostToDevice)))
+        return;
+    dev.graph = {d_offsets, d_targets, d_weights};
+
+    // dist, parent, two stamps, near, next and two far piles per slot; use
+    // at most 3/4 of the free memory.
+    std::size_t free_bytes = 0, total_bytes = 0;
+    if (!dev.check(cudaMemGetInfo(&free_bytes, &total_bytes)))
+        return;
+    std::size_t slot_bytes = dev.n1 * (sizeof(gpu_dist) + 7 * sizeof(int));
+    dev.batch = (int)std::min<std::size_t>(GPU_MAX_BATCH, free_bytes / 4 * 3 / slot_bytes);
+    if (dev.batch < 1)
+    {
+        dev.error = "not enough device memory for one search";
+        return;
+    }
+
+    std::size_t total = dev.batch * dev.n1;
+    GpuBuffers &b = dev.buf;
+    if (!dev.alloc(b.dist, total) || !dev.alloc(b.parent, total) || !dev.alloc(b.near_stamp, total) ||
+        !dev.alloc(b.far_stamp, total) || !dev.alloc(b.near, total) || !dev.alloc(b.next, total) ||
+        !dev.alloc(b.far[0], total) || !dev.alloc(b.far[1], total) || !dev.alloc(dev.slots, dev.batch) ||
+        !dev.alloc(dev.sources, dev.batch))
+    {
+        dev.batch = 0;
+        return;
+    }
+}
+
+GpuSssp::~GpuSssp() = default;
+
+bool GpuSssp::ok() const { return device_->batch > 0; }
+const std::string &GpuSssp::error() const { return device_->error; }
+const std::string &GpuSssp::device_name() const { return device_->name; }
+int GpuSssp::max_batch() const { return device_->batch; }
+
+bool GpuSssp::run(const int *sources, int count, long long delta, long long *dist, int *parent)
+{
+    Device &dev = *device_;
+    if (count < 1 || count > dev.batch)
+    {
+        dev.error = "batch size out of range";
+        return false;
+    }
+    const std::size_t n1 = dev.n1;
+    std::vector<GpuSlot> slots(count);
+    GpuBuffers &buf = dev.buf;
+
+    // Blocks per row: enough for the largest frontier, capped, since the
+    // kernels loop over their range.
+    auto blocks = [](int items)
+    { return dim3((unsigned)std::clamp((items + GPU_THREADS - 1) / GPU_THREADS, 1, 4096)); };
+    auto grid = [&](int items)
+    {
+        dim3 g = blocks(items);
+        g.y = count;
+        return g;
+    };
+    auto read_slots = [&]
+    { return dev.check(cudaMemcpy(slots.data(), dev.slots, count * sizeof(GpuSlot), cudaMemcpyDeviceToHost)); };
+    auto write_slots = [&]
+    { return dev.check(cudaMemcpy(dev.slots, slots.data(), count * sizeof(GpuSlot), cudaMemcpyHostToDevice)); };
+
+    std::size_t total = count * n1;
+    gpu_init<<<(unsigned)std::min<std::size_t>((total + GPU_THREADS - 1) / GPU_THREADS, 65535), GPU_THREADS>>>(
+        buf, total);
+    if (!dev.check(cudaMemcpy(dev.sources, sources, count * sizeof(int), cudaMemcpyHostToDevice)))
+        return false;
+    gpu_seed<<<1, GPU_MAX_BATCH>>>(buf, dev.slots, dev.sources, count, n1, (gpu_dist)delta);
+    if (!read_slots())
+        return false;
+
+    // Near-far phases. After each relaxation the next frontier becomes the
+    // near one; a slot whose frontier is empty splits its far pile, with the
+    // threshold moved to delta past the smallest far distance, until either
+    // work appears or the pile is gone.
+    int iteration = 0;
+    while (true)
+    {
+        int widest = 0;
+        for (const auto &s : slots)
+            widest = std::max(widest, s.near_count);
+        if (widest == 0)
+            break;
+        gpu_relax<<<grid(widest), GPU_THREADS>>>(dev.graph, buf, dev.slots, n1, iteration);
+        if (!dev.check(cudaGetLastError()) || !read_slots())
+            return false;
+        std::swap(buf.near, buf.next);
+        for (auto &s : slots)
+        {
+            s.near_count = s.next_count;
+            s.next_count = 0;
+        }
+
+        while (true)
+        {
+            int widest_far = 0;
+            for (auto &s : slots)
+            {
+                s.splitting = s.near_count == 0 && s.far_count > 0;
+                if (!s.splitting)
+                    continue;
+                s.prev_threshold = s.threshold;
+                s.threshold = std::max(s.threshold, s.far_min) + (gpu_dist)delta;
+                s.far_min = GPU_INF;
+                s.far_next_count = 0;
+                ++s.phase;
+                widest_far = std::max(widest_far, s.far_count);
+            }
+            if (!write_slots())
+                return false;
+            if (widest_far == 0)
+                break;
+            gpu_split<<<grid(widest_far), GPU_THREADS>>>(buf, dev.slots, n1, iteration);
+            if (!dev.check(cudaGetLastError()) || !read_slots())
+                return false;
+            for (auto &s : slots)
+            {
+                if (!s.splitting)
+                    continue;
+                s.far_parity ^= 1;
+                s.far_count = s.far_next_count;
+                s.splitting = 0;
+            }
+        }
+        ++iteration;
+    }
+
+    static_assert(sizeof(gpu_dist) == sizeof(long long), "distances are copied as-is");
+    if (!dev.check(cudaMemcpy(dist, buf.dist, total * sizeof(gpu_dist), cudaMemcpyDeviceToHost)))
+        return false;
+    if (!parent)
+        return true;
+
+    // Parent pass: level-synchronous over tight arcs, from the sources. The
+    // sources claim themselves first and are reset afterwards.
+    for (int k = 0; k < count; ++k)
+    {
+        slots[k] = GpuSlot{};
+        slots[k].near_count = 1;
+        int s = sources[k];
+        if (!dev.check(cudaMemcpy(buf.near + k * n1, &s, sizeof s, cudaMemcpyHostToDevice)) ||
+            !dev.check(cudaMemcpy(buf.parent + k * n1 + s, &s, sizeof s, cudaMemcpyHostToDevice)))
+            return false;
+    }
+    if (!write_slots())
+        return false;
+    while (true)
+    {
+        int widest = 0;
+        for (const auto &s : slots)
+            widest = std::max(widest, s.near_count);
+        if (widest == 0)
+            break;
+        gpu_tree<<<grid(widest), GPU_THREADS>>>(dev.graph, buf, dev.slots, n1);
+        if (!dev.check(cudaGetLastError()) || !read_slots())
+            return false;
+        std::swap(buf.near, buf.next);
+        for (auto &s : slots)
+        {
+            s.near_count = s.next_count;
+            s.next_count = 0;
+        }
+        if (!write_slots())
+            return false;
+    }
+    if (!dev.check(cudaMemcpy(parent, buf.parent, total * sizeof(int), cudaMemcpyDeviceToHost)))
+        return false;
+    for (int k = 0; k < count; ++k)
+        parent[k * n1 + sources[k]] = -1;
+    return true;
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+
+// Optional CUDA backend (CMake option DIJKSTRA_CUDA, target dijkstra_gpu).
+// The graph is copied to the device once; searches then run as a frontier
+// based near-far SSSP (a delta-stepping variant with two piles: nodes below
+// the current threshold are relaxed in bulk, the rest wait in a far pile
+// that is split when the near frontier runs dry). Up to max_batch() sources
+// run side by side, one grid row each, so small frontiers still fill the
+// device. Parents come from a second frontier pass over tight arcs, which
+// gives a tree even with zero-weight arcs.
+//
+// This part is compiled by nvcc as well and sticks to plain C++17 types; the
+// CsrGraph/DijkstraResult wrappers below are host-only.
+
+// Same value as DIST_INF in dijkstra.hpp.
+inline constexpr long long GPU_DIST_INF = std::numeric_limits<long long>::max() / 4;
+
+class GpuSssp
+{
+public:
+    // Copies the CSR arrays (n + 2 offsets, arcs targets and weights) to
+    // the first CUDA device. Check ok() afterwards.
+    GpuSssp(int n, const std::uint64_t *offsets, const int *targets, const int *weights, std::size_t arcs);
+    ~GpuSssp();
+    GpuSssp(const GpuSssp &) = delete;
+    GpuSssp &operator=(const GpuSssp &) = delete;
+
+    bool ok() const;
+    // Why the last call failed.
+    const std::string &error() const;
+    const std::string &device_name() const;
+    // Sources run per launch, limited by device memory.
+    int max_batch() const;
+
+    // Full trees from count sources. dist and parent receive count rows of
+    // n + 1 entries (index 0 unused, DIST_INF / -1 when unreached); a null
+    // parent skips the tree pass. False on a CUDA error.
+    bool run(const int *sources, int count, long long delta, long long *dist, int *parent);
+
+private:
+    struct Device;
+    std::unique_ptr<Device> device_;
+};
+
+#ifndef __CUDACC__
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "batch.hpp"
+#include "delta_stepping.hpp"
+#include "dijkstra.hpp"
+#include "graph.hpp"
+
+static_assert(GPU_DIST_INF == DIST_INF);
+
+// Uploads graph; null (with a message) when no usable device is found.
+inline std::unique_ptr<GpuSssp> make_gpu_sssp(const CsrGraph &graph)
+{
+    auto gpu = std::make_unique<GpuSssp>(graph.num_nodes(), graph.offsets().data(), graph.all_targets().data(),
+                                         graph.all_weights().data(), graph.num_edges());
+    if (!gpu->ok())
+    {
+        std::cerr << "GPU backend unavailable: " << gpu->error() << "\n";
+        return nullptr;
+    }
+    return gpu;
+}
+
+// One DijkstraResult per source, as from dijkstra_sequential. delta <= 0
+// picks default_delta(graph). Empty on a device error.
+inline std::vector<DijkstraResult> gpu_sssp(GpuSssp &gpu, const CsrGraph &graph, std::span<const int> sources,
+                                            long long delta = 0)
+{
+    if (delta <= 0)
+        delta = default_delta(graph);
+    const std::size_t n1 = graph.num_nodes() + 1;
+    std::vector<DijkstraResult> results(sources.size());
+    std::vector<long long> dist;
+    std::vector<int> parent;
+    for (std::size_t begin = 0; begin < sources.size(); begin += gpu.max_batch())
+    {
+        int count = (int)std::min<std::size_t>(gpu.max_batch(), sources.size() - begin);
+        dist.resize(count * n1);
+        parent.resize(count * n1);
+        if (!gpu.run(sources.data() + begin, count, delta, dist.data(), parent.data()))
+        {
+            std::cerr << "GPU search failed: " << gpu.error() << "\n";
+            return {};
+        }
+        for (int k = 0; k < count; ++k)
+        {
+            results[begin + k].dist.assign(dist.begin() + k * n1, dist.begin() + (k + 1) * n1);
+            results[begin + k].parent.assign(parent.begin() + k * n1, parent.begin() + (k + 1) * n1);
+        }
+    }
+    return results;
+}
+
+// Batch mode on the device: every distinct source gets one full tree, built
+// max_batch() at a time, and the queries read their targets from it. A
+// query's latency is the time of the launch that answered it.
+inline bool run_batch_gpu(GpuSssp &gpu, const CsrGraph &graph, const std::vector<QueryPair> &queries,
+                          std::vector<long long> &distances, BatchStats &stats, long long delta = 0)
+{
+    if (delta <= 0)
+        delta = default_delta(graph);
+    distances.assign(queries.size(), DIST_INF);
+    std::vector<double> latency_us(queries.size());
+
+    std::unordered_map<int, std::vector<std::size_t>> by_source;
+    std::vector<int> sources;
+    for (std::size_t i = 0; i < queries.size(); ++i)
+    {
+        auto &list = by_source[queries[i].source];
+        if (list.empty())
+            sources.push_back(queries[i].source);
+        list.push_back(i);
+    }
+
+    const std::size_t n1 = graph.num_nodes() + 1;
+    std::vector<long long> dist;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t begin = 0; begin < sources.size(); begin += gpu.max_batch())
+    {
+        int count = (int)std::min<std::size_t>(gpu.max_batch(), sources.size() - begin);
+        dist.resize(count * n1);
+        auto t1 = std::chrono::steady_clock::now();
+        if (!gpu.run(sources.data() + begin, count, delta, dist.data(), nullptr))
+        {
+            std::cerr << "GPU search failed: " << gpu.error() << "\n";
+            return false;
+        }
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t1).count();
+        for (int k = 0; k < count; ++k)
+        {
+            for (std::size_t i : by_source[sources[begin + k]])
+            {
+                distances[i] = dist[k * n1 + queries[i].target];
+                latency_us[i] = us;
+            }
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    stats = batch_stats(latency_us, std::chrono::duration<double>(end - start).count());
+    return true;
+}
+
+#endif
@@ -0,0 +1,37 @@
+#include <iostream>
+#include <string>
+
+#include "dimacs.hpp"
+#include "graph_cache.hpp"
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <graph.gr> [output.csr]\n";
+        return 1;
+    }
+
+    std::string input = argv[1];
+    std::string output = argc > 2 ? argv[2] : graph_cache_path(input);
+
+    SourceStamp stamp;
+    if (!stat_source(input, stamp))
+    {
+        std::cerr << "Could not open file " << input << "\n";
+        return 1;
+    }
+
+    CsrGraph graph;
+    int n_nodes = 0;
+    LoadStats load;
+    if (!read_dimacs_gr(input, graph, n_nodes, &load))
+        return 1;
+    std::cout << "Parsed " << n_nodes << " nodes, " << graph.num_edges() << " arcs in " << load.seconds * 1000.0
+              << " ms (" << load.mb_per_s() << " MB/s)\n";
+
+    if (!write_graph_cache(output, graph, stamp))
+        return 1;
+    std::cout << "Wrote " << output << "\n";
+    return 0;
+}
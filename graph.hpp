@@ -0,0 +1,244 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/task_arena.h>
+
+struct Edge
+{
+    int to;
+    int weight;
+};
+
+// Immutable compressed-sparse-row graph. Node ids are 1-based as in DIMACS,
+// so slot 0 is an empty placeholder and the out-arcs of u live in
+// [offsets[u], offsets[u + 1]) of the packed targets/weights arrays.
+// The arrays are either owned or views into storage kept alive by the graph
+// (e.g. a memory-mapped cache file), so copies are cheap and share data.
+class CsrGraph
+{
+public:
+    CsrGraph() = default;
+
+    CsrGraph(std::vector<std::uint64_t> offsets, std::vector<int> targets, std::vector<int> weights)
+    {
+        auto arrays = std::make_shared<OwnedArrays>(OwnedArrays{std::move(offsets), std::move(targets), std::move(weights)});
+        offsets_ = arrays->offsets;
+        targets_ = arrays->targets;
+        weights_ = arrays->weights;
+        storage_ = std::move(arrays);
+        max_weight_ = compute_max_weight(weights_);
+    }
+
+    CsrGraph(std::span<const std::uint64_t> offsets, std::span<const int> targets, std::span<const int> weights,
+             std::shared_ptr<const void> storage, int max_weight)
+        : offsets_(offsets), targets_(targets), weights_(weights), storage_(std::move(storage)),
+          max_weight_(max_weight)
+    {
+    }
+
+    int num_nodes() const { return offsets_.empty() ? 0 : (int)offsets_.size() - 2; }
+    std::size_t num_edges() const { return targets_.size(); }
+
+    std::size_t degree(int u) const { return offsets_[u + 1] - offsets_[u]; }
+
+    std::span<const int> targets(int u) const { return targets_.subspan(offsets_[u], degree(u)); }
+    std::span<const int> weights(int u) const { return weights_.subspan(offsets_[u], degree(u)); }
+
+    std::span<const std::uint64_t> offsets() const { return offsets_; }
+    std::span<const int> all_targets() const { return targets_; }
+    std::span<const int> all_weights() const { return weights_; }
+
+    // Largest arc weight, 0 for a graph without arcs.
+    int max_weight() const { return max_weight_; }
+
+    static int compute_max_weight(std::span<const int> weights)
+    {
+        return tbb::parallel_reduce(
+            tbb::blocked_range<std::size_t>(0, weights.size()), 0,
+            [&](const tbb::blocked_range<std::size_t> &r, int m)
+            {
+                for (std::size_t i = r.begin(); i < r.end(); ++i)
+                    m = std::max(m, weights[i]);
+                return m;
+            },
+            [](int a, int b) { return std::max(a, b); });
+    }
+
+private:
+    struct OwnedArrays
+    {
+        std::vector<std::uint64_t> offsets;
+        std::vector<int> targets;
+        std::vector<int> weights;
+    };
+
+    std::span<const std::uint64_t> offsets_;
+    std::span<const int> targets_;
+    std::span<const int> weights_;
+    std::shared_ptr<const void> storage_;
+    int max_weight_ = 0;
+};
+
+// Arcs parsed from one slice of the input, in input order.
+struct ArcBuffer
+{
+    std::vector<int> sources;
+    std::vector<int> targets;
+    std::vector<int> weights;
+
+    std::size_t size() const { return sources.size(); }
+};
+
+// Builds a CSR graph from per-thread arc buffers with a stable two-level
+// parallel counting sort on the source node: arcs are first scattered into
+// contiguous node-range buckets (buffer order preserved), then each bucket is
+// counting-sorted on its own. Arcs keep their input order within each
+// adjacency, so the result does not depend on the thread count.
+inline CsrGraph build_csr(int n_nodes, std::vector<ArcBuffer> buffers)
+{
+    if (buffers.size() == 1)
+    {
+        const auto &sources = buffers[0].sources;
+        if (std::is_sorted(sources.begin(), sources.end()))
+        {
+            std::vector<std::uint64_t> offsets(n_nodes + 2, 0);
+            for (int u : sources)
+                ++offsets[u + 1];
+            for (int u = 1; u <= n_nodes + 1; ++u)
+                offsets[u] += offsets[u - 1];
+            return {std::move(offsets), std::move(buffers[0].targets), std::move(buffers[0].weights)};
+        }
+    }
+
+    const std::size_t n_buffers = buffers.size();
+    const std::size_t n_buckets =
+        std::max<std::size_t>(1, std::min<std::size_t>(n_nodes, 4 * tbb::this_task_arena::max_concurrency()));
+    const std::size_t bucket_width = n_nodes == 0 ? 1 : (n_nodes + n_buckets - 1) / n_buckets;
+    auto bucket_of = [&](int u) { return (std::size_t)(u - 1) / bucket_width; };
+
+    // counts[c * n_buckets + b] becomes the write position of buffer c in bucket b.
+    std::vector<std::uint64_t> counts(n_buffers * n_buckets, 0);
+    tbb::parallel_for(std::size_t(0), n_buffers, [&](std::size_t c)
+                      {
+        std::uint64_t *row = counts.data() + c * n_buckets;
+        for (int u : buffers[c].sources)
+            ++row[bucket_of(u)]; });
+
+    std::vector<std::uint64_t> bucket_start(n_buckets + 1, 0);
+    std::uint64_t total = 0;
+    for (std::size_t b = 0; b < n_buckets; ++b)
+    {
+        bucket_start[b] = total;
+        for (std::size_t c = 0; c < n_buffers; ++c)
+        {
+            std::uint64_t count = counts[c * n_buckets + b];
+            counts[c * n_buckets + b] = total;
+            total += count;
+        }
+    }
+    bucket_start[n_buckets] = total;
+
+    std::vector<int> sources(total);
+    std::vector<int> targets(total);
+    std::vector<int> weights(total);
+    tbb::parallel_for(std::size_t(0), n_buffers, [&](std::size_t c)
+                      {
+        std::uint64_t *cursor = counts.data() + c * n_buckets;
+        const auto &buf = buffers[c];
+        for (std::size_t i = 0; i < buf.size(); ++i)
+        {
+            std::uint64_t pos = cursor[bucket_of(buf.sources[i])]++;
+            sources[pos] = buf.sources[i];
+            targets[pos] = buf.targets[i];
+            weights[pos] = buf.weights[i];
+        }
+        buffers[c] = ArcBuffer(); });
+    buffers.clear();
+
+    std::vector<std::uint64_t> offsets(n_nodes + 2, 0);
+    offsets[n_nodes + 1] = total;
+    tbb::parallel_for(std::size_t(0), n_buckets, [&](std::size_t b)
+                      {
+        int lo = (int)(b * bucket_width) + 1;
+        int hi = (int)std::min<std::size_t>((b + 1) * bucket_width, n_nodes);
+        std::uint64_t begin = bucket_start[b];
+        std::uint64_t end = bucket_start[b + 1];
+        if (lo > hi)
+            return;
+
+        std::vector<std::uint64_t> degree(hi - lo + 2, 0);
+        bool sorted = true;
+        for (std::uint64_t i = begin; i < end; ++i)
+        {
+            ++degree[sources[i] - lo + 1];
+            if (i > begin && sources[i] < sources[i - 1])
+                sorted = false;
+        }
+        degree[0] = begin;
+        for (int u = lo; u <= hi; ++u)
+        {
+            degree[u - lo + 1] += degree[u - lo];
+            offsets[u] = degree[u - lo];
+        }
+
+        if (sorted)
+            return;
+
+        std::vector<int> local_targets(end - begin);
+        std::vector<int> local_weights(end - begin);
+        for (std::uint64_t i = begin; i < end; ++i)
+        {
+            std::uint64_t pos = degree[sources[i] - lo]++ - begin;
+            local_targets[pos] = targets[i];
+            local_weights[pos] = weights[i];
+        }
+        std::copy(local_targets.begin(), local_targets.end(), targets.begin() + begin);
+        std::copy(local_weights.begin(), local_weights.end(), weights.begin() + begin); });
+
+    return {std::move(offsets), std::move(targets), std::move(weights)};
+}
+
+// Transposes a graph (every arc u -> v becomes v -> u) with the same
+// parallel counting sort, for backward searches.
+inline CsrGraph reverse_graph(const CsrGraph &graph)
+{
+    const int n = graph.num_nodes();
+    const std::size_t n_slices = std::max<std::size_t>(1, std::min<std::size_t>(n, 4 * tbb::this_task_arena::max_concurrency()));
+    const std::size_t slice = n == 0 ? 1 : (n + n_slices - 1) / n_slices;
+
+    std::vector<ArcBuffer> buffers(n_slices);
+    tbb::parallel_for(std::size_t(0), n_slices, [&](std::size_t c)
+                      {
+        int lo = (int)(c * slice) + 1;
+        int hi = (int)std::min<std::size_t>((c + 1) * slice, n);
+        auto &buf = buffers[c];
+        if (lo > hi)
+            return;
+        std::size_t arcs = graph.offsets()[hi + 1] - graph.offsets()[lo];
+        buf.sources.reserve(arcs);
+        buf.targets.reserve(arcs);
+        buf.weights.reserve(arcs);
+        for (int u = lo; u <= hi; ++u)
+        {
+            auto targets = graph.targets(u);
+            auto weights = graph.weights(u);
+            for (std::size_t i = 0; i < targets.size(); ++i)
+            {
+                buf.sources.push_back(targets[i]);
+                buf.targets.push_back(u);
+                buf.weights.push_back(weights[i]);
+            }
+        } });
+
+    return build_csr(n, std::move(buffers));
+}
@@ -0,0 +1,276 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_reduce.h>
+#include <unistd.h>
+
+#include "dimacs.hpp"
+#include "graph.hpp"
+#include "mapped_file.hpp"
+
+// On-disk CSR layout: a fixed header followed by the offsets, targets and
+// weights arrays, each starting on a 64-byte boundary so they can be used
+// in place from a read-only mapping.
+struct GraphCacheHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint64_t n_nodes;
+    std::uint64_t n_arcs;
+    std::uint64_t max_weight;
+    std::uint64_t source_size;
+    std::int64_t source_mtime;
+    std::uint64_t offsets_pos;
+    std::uint64_t targets_pos;
+    std::uint64_t weights_pos;
+};
+
+inline constexpr char GRAPH_CACHE_MAGIC[8] = {'D', 'J', 'K', 'C', 'S', 'R', '\0', '\0'};
+inline constexpr std::uint32_t GRAPH_CACHE_VERSION = 2;
+inline constexpr std::uint32_t GRAPH_CACHE_BYTE_ORDER = 0x01020304;
+
+// Identifies the text file a cache was built from.
+struct SourceStamp
+{
+    std::uint64_t size = 0;
+    std::int64_t mtime = 0;
+
+    bool operator==(const SourceStamp &) const = default;
+};
+
+inline bool stat_source(const std::string &filename, SourceStamp &stamp)
+{
+    std::error_code ec;
+    auto size = std::filesystem::file_size(filename, ec);
+    if (ec)
+        return false;
+    auto mtime = std::filesystem::last_write_time(filename, ec);
+    if (ec)
+        return false;
+    stamp.size = size;
+    stamp.mtime = std::chrono::duration_cast<std::chrono::nanoseconds>(mtime.time_since_epoch()).count();
+    return true;
+}
+
+inline std::uint64_t align_up(std::uint64_t pos, std::uint64_t alignment)
+{
+    return (pos + alignment - 1) / alignment * alignment;
+}
+
+// One block of a binary sidecar file, written at byte offset pos.
+struct FileSection
+{
+    std::uint64_t pos;
+    const void *data;
+    std::size_t bytes;
+};
+
+// Writes sections (in increasing pos order, gaps zero-filled) to path
+// atomically: a temp file is renamed over path once complete, so readers
+// never map a partial file. The temp name is unique per process and call, so
+// concurrent writers of the same file do not truncate each other. The temp
+// file is removed on failure.
+inline bool write_file_sections(const std::string &path, const std::vector<FileSection> &sections)
+{
+    static std::atomic<unsigned> serial{0};
+    std::string tmp = path + ".tmp." + std::to_string(::getpid()) + "." + std::to_string(serial++);
+    std::error_code ec;
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            std::cerr << "Could not create " << tmp << "\n";
+            return false;
+        }
+
+        static const char zeros[64] = {};
+        std::uint64_t here = 0;
+        for (const auto &s : sections)
+        {
+            while (here < s.pos)
+            {
+                std::uint64_t gap = std::min<std::uint64_t>(sizeof zeros, s.pos - here);
+                out.write(zeros, gap);
+                here += gap;
+            }
+            out.write((const char *)s.data, s.bytes);
+            here += s.bytes;
+        }
+
+        if (!out.flush())
+        {
+            std::cerr << "Error writing " << tmp << "\n";
+            out.close();
+            std::filesystem::remove(tmp, ec);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tmp, path, ec);
+    if (ec)
+    {
+        std::cerr << "Could not rename " << tmp << " to " << path << ": " << ec.message() << "\n";
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
+// Writes the graph to path atomically (temp file + rename).
+inline bool write_graph_cache(const std::string &path, const CsrGraph &graph, const SourceStamp &stamp)
+{
+    GraphCacheHeader header{};
+    std::memcpy(header.magic, GRAPH_CACHE_MAGIC, sizeof header.magic);
+    header.version = GRAPH_CACHE_VERSION;
+    header.byte_order = GRAPH_CACHE_BYTE_ORDER;
+    header.n_nodes = graph.num_nodes();
+    header.n_arcs = graph.num_edges();
+    header.max_weight = graph.max_weight();
+    header.source_size = stamp.size;
+    header.source_mtime = stamp.mtime;
+    header.offsets_pos = align_up(sizeof header, 64);
+    header.targets_pos = align_up(header.offsets_pos + graph.offsets().size_bytes(), 64);
+    header.weights_pos = align_up(header.targets_pos + graph.all_targets().size_bytes(), 64);
+
+    return write_file_sections(path, {{0, &header, sizeof header},
+                                      {header.offsets_pos, graph.offsets().data(), graph.offsets().size_bytes()},
+                                      {header.targets_pos, graph.all_targets().data(),
+                                       graph.all_targets().size_bytes()},
+                                      {header.weights_pos, graph.all_weights().data(),
+                                       graph.all_weights().size_bytes()}});
+}
+
+// One parallel pass over what the engines index without bounds checks:
+// offsets non-decreasing and within the arcs, every target a node in [1, n]
+// and every weight in [0, max_weight].
+inline bool valid_csr_arrays(std::span<const std::uint64_t> offsets, std::span<const int> targets,
+                             std::span<const int> weights, int max_weight)
+{
+    const int n = (int)offsets.size() - 2;
+    auto all = [](auto range, auto ok)
+    {
+        return tbb::parallel_reduce(
+            range, true, [&](const auto &r, bool valid)
+            {
+                for (auto i = r.begin(); i < r.end() && valid; ++i)
+                    valid = ok(i);
+                return valid;
+            },
+            [](bool a, bool b) { return a && b; });
+    };
+    return all(tbb::blocked_range<std::size_t>(0, offsets.size() - 1, 4096),
+               [&](std::size_t u) { return offsets[u] <= offsets[u + 1]; }) &&
+           all(tbb::blocked_range<std::size_t>(0, targets.size(), 16384),
+               [&](std::size_t a)
+               { return targets[a] >= 1 && targets[a] <= n && weights[a] >= 0 && weights[a] <= max_weight; });
+}
+
+// Maps a binary CSR file and builds a zero-copy graph view over it. When
+// expected is given, a cache built from a different source is rejected, as
+// is a file whose arrays fail valid_csr_arrays (truncated or edited).
+inline bool map_graph_cache(const std::string &path, CsrGraph &graph, const SourceStamp *expected = nullptr)
+{
+    auto file = map_file(path);
+    if (!file || file->size() < sizeof(GraphCacheHeader))
+        return false;
+
+    GraphCacheHeader header;
+    std::memcpy(&header, file->data(), sizeof header);
+    if (std::memcmp(header.magic, GRAPH_CACHE_MAGIC, sizeof header.magic) != 0 ||
+        header.version != GRAPH_CACHE_VERSION || header.byte_order != GRAPH_CACHE_BYTE_ORDER)
+        return false;
+    if (header.max_weight > (std::uint64_t)std::numeric_limits<int>::max() ||
+        header.n_nodes >= (std::uint64_t)std::numeric_limits<int>::max())
+        return false;
+    if (expected && (header.source_size != expected->size || header.source_mtime != expected->mtime))
+        return false;
+
+    std::uint64_t offsets_bytes = (header.n_nodes + 2) * sizeof(std::uint64_t);
+    std::uint64_t arcs_bytes = header.n_arcs * sizeof(int);
+    if (header.n_arcs > file->size() || header.offsets_pos % 64 || header.targets_pos % 64 || header.weights_pos % 64 ||
+        header.offsets_pos + offsets_bytes > file->size() || header.targets_pos + arcs_bytes > file->size() ||
+        header.weights_pos + arcs_bytes > file->size())
+        return false;
+
+    auto offsets = std::span((const std::uint64_t *)(file->data() + header.offsets_pos), header.n_nodes + 2);
+    if (offsets.front() != 0 || offsets.back() != header.n_arcs)
+        return false;
+
+    auto targets = std::span((const int *)(file->data() + header.targets_pos), header.n_arcs);
+    auto weights = std::span((const int *)(file->data() + header.weights_pos), header.n_arcs);
+    if (!valid_csr_arrays(offsets, targets, weights, (int)header.max_weight))
+        return false;
+    graph = CsrGraph(offsets, targets, weights, std::move(file), (int)header.max_weight);
+    return true;
+}
+
+inline bool is_graph_cache(const std::string &filename)
+{
+    std::ifstream in(filename, std::ios::binary);
+    char magic[sizeof GRAPH_CACHE_MAGIC] = {};
+    in.read(magic, sizeof magic);
+    return in && std::memcmp(magic, GRAPH_CACHE_MAGIC, sizeof magic) == 0;
+}
+
+inline std::string graph_cache_path(const std::string &filename)
+{
+    return filename + ".csr";
+}
+
+// Loads a graph from either a binary CSR file or a DIMACS .gr file. For text
+// input with use_cache set, the sibling "<file>.csr" is mapped when it matches
+// the source's size and mtime, and (re)built from the parsed text otherwise.
+inline bool load_graph(const std::string &filename, CsrGraph &graph, int &n_nodes, LoadStats *stats = nullptr,
+                       bool use_cache = true)
+{
+    auto start = std::chrono::steady_clock::now();
+    auto finish = [&](std::size_t bytes)
+    {
+        n_nodes = graph.num_nodes();
+        if (stats)
+        {
+            stats->bytes = bytes;
+            stats->arcs = graph.num_edges();
+            stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            stats->cached = true;
+        }
+        return true;
+    };
+
+    if (is_graph_cache(filename))
+    {
+        if (!map_graph_cache(filename, graph))
+        {
+            std::cerr << "Invalid binary graph file " << filename << "\n";
+            return false;
+        }
+        return finish(std::filesystem::file_size(filename));
+    }
+
+    SourceStamp stamp;
+    std::string cache = graph_cache_path(filename);
+    if (use_cache && stat_source(filename, stamp) && map_graph_cache(cache, graph, &stamp))
+        return finish(std::filesystem::file_size(cache));
+
+    if (!read_dimacs_gr(filename, graph, n_nodes, stats))
+        return false;
+
+    if (use_cache && stamp.size != 0 && !write_graph_cache(cache, graph, stamp))
+        std::cerr << "Warning: could not write graph cache " << cache << "\n";
+    return true;
+}
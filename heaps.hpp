@@ -0,0 +1,472 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Priority queues over node ids [0, n] for Dijkstra. All backends share one
+// interface: construction from (n, max_weight), push_or_decrease(key, node)
+// inserts a node or lowers its key, and pop() returns {key, node} of the
+// minimum, and clear() empties the queue but keeps its storage for the next
+// query. The lazy backends (binary, radix, Dial) never decrease in place,
+// so their pops may be stale and callers must skip entries whose key no
+// longer matches the node's distance; the indexed backends only ever hold
+// one entry per node. Radix and Dial are monotone: keys pushed must not be
+// smaller than the last key popped, which holds for Dijkstra with
+// non-negative weights.
+
+template <typename Key>
+class LazyBinaryHeap
+{
+public:
+    explicit LazyBinaryHeap(int, int = 0) {}
+
+    bool empty() const { return heap_.empty(); }
+    std::size_t size() const { return heap_.size(); }
+    void clear() { heap_.clear(); }
+
+    void push_or_decrease(Key key, int node)
+    {
+        heap_.push_back({key, node});
+        std::push_heap(heap_.begin(), heap_.end(), std::greater<Item>());
+    }
+
+    std::pair<Key, int> pop()
+    {
+        std::pop_heap(heap_.begin(), heap_.end(), std::greater<Item>());
+        auto top = heap_.back();
+        heap_.pop_back();
+        return top;
+    }
+
+private:
+    using Item = std::pair<Key, int>;
+    std::vector<Item> heap_;
+};
+
+// Implicit D-ary heap with a node -> slot index for true decrease-key.
+template <typename Key, int D = 4>
+class DaryHeap
+{
+public:
+    explicit DaryHeap(int n, int = 0) : pos_(n + 1, NONE) {}
+
+    bool empty() const { return heap_.empty(); }
+    std::size_t size() const { return heap_.size(); }
+
+    void clear()
+    {
+        for (const auto &e : heap_)
+            pos_[e.node] = NONE;
+        heap_.clear();
+    }
+
+    void push_or_decrease(Key key, int node)
+    {
+        std::size_t i;
+        if (pos_[node] == NONE)
+        {
+            i = heap_.size();
+            heap_.push_back({key, node});
+        }
+        else
+        {
+            i = pos_[node];
+            if (!(key < heap_[i].key))
+                return;
+            heap_[i].key = key;
+        }
+        sift_up(i);
+    }
+
+    std::pair<Key, int> pop()
+    {
+        Entry top = heap_.front();
+        pos_[top.node] = NONE;
+        Entry last = heap_.back();
+        heap_.pop_back();
+        if (!heap_.empty())
+            sift_down(0, last);
+        return {top.key, top.node};
+    }
+
+private:
+    static constexpr int NONE = -1;
+
+    struct Entry
+    {
+        Key key;
+        int node;
+    };
+
+    void place(std::size_t i, const Entry &e)
+    {
+        heap_[i] = e;
+        pos_[e.node] = (int)i;
+    }
+
+    void sift_up(std::size_t i)
+    {
+        Entry e = heap_[i];
+        while (i > 0)
+        {
+            std::size_t p = (i - 1) / D;
+            if (!(e.key < heap_[p].key))
+                break;
+            place(i, heap_[p]);
+            i = p;
+        }
+        place(i, e);
+    }
+
+    void sift_down(std::size_t i, const Entry &e)
+    {
+        const std::size_t n = heap_.size();
+        while (true)
+        {
+            std::size_t first = i * D + 1;
+            if (first >= n)
+                break;
+            std::size_t last = first + D < n ? first + D : n;
+            std::size_t best = first;
+            for (std::size_t c = first + 1; c < last; ++c)
+                if (heap_[c].key < heap_[best].key)
+                    best = c;
+            if (!(heap_[best].key < e.key))
+                break;
+            place(i, heap_[best]);
+            i = best;
+        }
+        place(i, e);
+    }
+
+    std::vector<Entry> heap_;
+    std::vector<int> pos_;
+};
+
+template <typename Key>
+using QuaternaryHeap = DaryHeap<Key, 4>;
+
+// Pairing heap with per-node link arrays, so nodes never allocate and
+// decrease-key is a cut plus one link.
+template <typename Key>
+class PairingHeap
+{
+public:
+    explicit PairingHeap(int n, int = 0)
+        : key_(n + 1), child_(n + 1, NONE), sibling_(n + 1, NONE), prev_(n + 1, NONE), in_heap_(n + 1, false)
+    {
+    }
+
+    bool empty() const { return root_ == NONE; }
+    std::size_t size() const { return size_; }
+
+    void clear()
+    {
+        pairs_.clear();
+        if (root_ != NONE)
+            pairs_.push_back(root_);
+        while (!pairs_.empty())
+        {
+            int v = pairs_.back();
+            pairs_.pop_back();
+            in_heap_[v] = false;
+            for (int c = child_[v]; c != NONE; c = sibling_[c])
+                pairs_.push_back(c);
+        }
+        root_ = NONE;
+        size_ = 0;
+    }
+
+    void push_or_decrease(Key key, int node)
+    {
+        if (!in_heap_[node])
+        {
+            in_heap_[node] = true;
+            key_[node] = key;
+            child_[node] = sibling_[node] = prev_[node] = NONE;
+            root_ = root_ == NONE ? node : link(root_, node);
+            ++size_;
+            return;
+        }
+        if (!(key < key_[node]))
+            return;
+
+        key_[node] = key;
+        if (node == root_)
+            return;
+
+        int prev = prev_[node];
+        if (child_[prev] == node)
+            child_[prev] = sibling_[node];
+        else
+            sibling_[prev] = sibling_[node];
+        if (sibling_[node] != NONE)
+            prev_[sibling_[node]] = prev;
+        sibling_[node] = prev_[node] = NONE;
+        root_ = link(root_, node);
+    }
+
+    std::pair<Key, int> pop()
+    {
+        int top = root_;
+        in_heap_[top] = false;
+        --size_;
+
+        // Two-pass pairing: link children left to right in pairs, then fold
+        // the pairs right to left into the new root.
+        pairs_.clear();
+        for (int c = child_[top]; c != NONE;)
+        {
+            int a = c;
+            int b = sibling_[a];
+            c = b == NONE ? NONE : sibling_[b];
+            sibling_[a] = prev_[a] = NONE;
+            if (b != NONE)
+            {
+                sibling_[b] = prev_[b] = NONE;
+                a = link(a, b);
+            }
+            pairs_.push_back(a);
+        }
+
+        root_ = NONE;
+        for (auto it = pairs_.rbegin(); it != pairs_.rend(); ++it)
+            root_ = root_ == NONE ? *it : link(root_, *it);
+        return {key_[top], top};
+    }
+
+private:
+    static constexpr int NONE = -1;
+
+    // Links two roots; the loser becomes the winner's leftmost child.
+    int link(int a, int b)
+    {
+        if (key_[b] < key_[a])
+            std::swap(a, b);
+        sibling_[b] = child_[a];
+        if (child_[a] != NONE)
+            prev_[child_[a]] = b;
+        child_[a] = b;
+        prev_[b] = a;
+        return a;
+    }
+
+    std::vector<Key> key_;
+    std::vector<int> child_;
+    std::vector<int> sibling_;
+    std::vector<int> prev_;
+    std::vector<bool> in_heap_;
+    std::vector<int> pairs_;
+    int root_ = NONE;
+    std::size_t size_ = 0;
+};
+
+// Monotone radix heap: bucket i > 0 holds keys whose highest bit differing
+// from the last popped key is bit i - 1, so each entry moves to a lower
+// bucket at most once per bit.
+template <typename Key>
+class RadixHeap
+{
+public:
+    explicit RadixHeap(int, int = 0) {}
+
+    bool empty() const { return size_ == 0; }
+    std::size_t size() const { return size_; }
+
+    void clear()
+    {
+        for (auto &bucket : buckets_)
+            bucket.clear();
+        last_ = 0;
+        size_ = 0;
+    }
+
+    void push_or_decrease(Key key, int node)
+    {
+        buckets_[bucket_of((UKey)key)].push_back({key, node});
+        ++size_;
+    }
+
+    std::pair<Key, int> pop()
+    {
+        if (buckets_[0].empty())
+        {
+            std::size_t i = 1;
+            while (buckets_[i].empty())
+                ++i;
+
+            auto &from = buckets_[i];
+            Key min_key = from.front().first;
+            for (const auto &item : from)
+                min_key = std::min(min_key, item.first);
+            last_ = (UKey)min_key;
+            for (const auto &item : from)
+                buckets_[bucket_of((UKey)item.first)].push_back(item);
+            from.clear();
+        }
+
+        auto top = buckets_[0].back();
+        buckets_[0].pop_back();
+        --size_;
+        return top;
+    }
+
+private:
+    using UKey = std::make_unsigned_t<Key>;
+    static constexpr int BITS = std::numeric_limits<UKey>::digits;
+
+    std::size_t bucket_of(UKey key) const { return key == last_ ? 0 : BITS - std::countl_zero(UKey(key ^ last_)); }
+
+    std::array<std::vector<std::pair<Key, int>>, BITS + 1> buckets_;
+    UKey last_ = 0;
+    std::size_t size_ = 0;
+};
+
+// Dial's bucket queue: with arcs of weight at most C every queued key lies in
+// [current, current + C], so C + 1 circular buckets of node ids identify each
+// key exactly and pop is a scan to the next non-empty bucket.
+template <typename Key>
+class DialQueue
+{
+public:
+    explicit DialQueue(int, int max_weight = 0) : buckets_((std::size_t)max_weight + 1) {}
+
+    bool empty() const { return size_ == 0; }
+    std::size_t size() const { return size_; }
+
+    void clear()
+    {
+        for (auto &bucket : buckets_)
+            bucket.clear();
+        current_ = 0;
+        size_ = 0;
+    }
+
+    void push_or_decrease(Key key, int node)
+    {
+        buckets_[(std::size_t)(key % (Key)buckets_.size())].push_back(node);
+        ++size_;
+    }
+
+    std::pair<Key, int> pop()
+    {
+        std::size_t slot = (std::size_t)(current_ % (Key)buckets_.size());
+        while (buckets_[slot].empty())
+        {
+            ++current_;
+            if (++slot == buckets_.size())
+                slot = 0;
+        }
+
+        int node = buckets_[slot].back();
+        buckets_[slot].pop_back();
+        --size_;
+        return {current_, node};
+    }
+
+private:
+    std::vector<std::vector<int>> buckets_;
+    Key current_ = 0;
+    std::size_t size_ = 0;
+};
+
+// Largest max arc weight for which auto picks Dial's buckets over the radix heap.
+inline constexpr int DIAL_MAX_WEIGHT = 1 << 12;
+// Largest max arc weight Dial's buckets are built for even on request: there
+// is one bucket per weight value, and each query clears all of them.
+inline constexpr int DIAL_LIMIT_WEIGHT = 1 << 20;
+
+enum class QueueKind
+{
+    Auto,
+    Binary,
+    Dary,
+    Pairing,
+    Radix,
+    Dial,
+};
+
+inline bool parse_queue_kind(const std::string &name, QueueKind &kind)
+{
+    if (name == "auto")
+        kind = QueueKind::Auto;
+    else if (name == "binary")
+        kind = QueueKind::Binary;
+    else if (name == "dary")
+        kind = QueueKind::Dary;
+    else if (name == "pairing")
+        kind = QueueKind::Pairing;
+    else if (name == "radix")
+        kind = QueueKind::Radix;
+    else if (name == "dial")
+        kind = QueueKind::Dial;
+    else
+        return false;
+    return true;
+}
+
+inline const char *queue_kind_name(QueueKind kind)
+{
+    switch (kind)
+    {
+    case QueueKind::Auto:
+        return "auto";
+    case QueueKind::Binary:
+        return "binary";
+    case QueueKind::Dary:
+        return "dary";
+    case QueueKind::Pairing:
+        return "pairing";
+    case QueueKind::Radix:
+        return "radix";
+    case QueueKind::Dial:
+        return "dial";
+    }
+    return "?";
+}
+
+// Integer weights make the monotone queues applicable to every graph; the
+// weight range decides between Dial's buckets and the radix heap. A Dial
+// request past DIAL_LIMIT_WEIGHT falls back to the radix heap with a warning.
+inline QueueKind resolve_queue_kind(QueueKind kind, int max_weight)
+{
+    if (kind == QueueKind::Dial && max_weight > DIAL_LIMIT_WEIGHT)
+    {
+        std::cerr << "Warning: max weight " << max_weight << " is too large for the dial queue (limit "
+                  << DIAL_LIMIT_WEIGHT << "), using radix\n";
+        return QueueKind::Radix;
+    }
+    if (kind != QueueKind::Auto)
+        return kind;
+    return max_weight <= DIAL_MAX_WEIGHT ? QueueKind::Dial : QueueKind::Radix;
+}
+
+// Calls f.template operator()<Queue>() with the queue template selected by a
+// resolved (non-auto) kind.
+template <typename F>
+decltype(auto) with_queue(QueueKind kind, F &&f)
+{
+    switch (kind)
+    {
+    case QueueKind::Binary:
+        return f.template operator()<LazyBinaryHeap>();
+    case QueueKind::Pairing:
+        return f.template operator()<PairingHeap>();
+    case QueueKind::Radix:
+        return f.template operator()<RadixHeap>();
+    case QueueKind::Dial:
+        return f.template operator()<DialQueue>();
+    case QueueKind::Dary:
+    default:
+        return f.template operator()<QuaternaryHeap>();
+    }
+}
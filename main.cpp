@@ -1,247 +1,700 @@
+#include <filesystem>
+#include <memory>
+#include <fstream>
 #include <iostream>
 #include <tbb/global_control.h>
-#include <tbb/parallel_for.h>
 #include <chrono>
-#include <queue>
-#include <limits>
-#include <fstream>
-#include <sstream>
+#include <optional>
+#include <span>
 #include <string>
 #include <vector>
 #include <algorithm>
-#include <mutex>
+
+#include "alt.hpp"
+#include "astar.hpp"
+#include "batch.hpp"
+#include "bidirectional.hpp"
+#include "ch.hpp"
+#include "compressed_graph.hpp"
+#include "delta_stepping.hpp"
+#include "dijkstra.hpp"
+#include "dynamic.hpp"
+#include "graph.hpp"
+#include "graph_cache.hpp"
+#include "heaps.hpp"
+#include "out_of_core.hpp"
+#include "parse_number.hpp"
+#include "relax_tuning.hpp"
+#include "reorder.hpp"
+#include "search_stats.hpp"
+#include "threading.hpp"
+#include "tree_cache.hpp"
+#include "validate.hpp"
+
+#ifdef DIJKSTRA_GPU
+#include "gpu_sssp.hpp"
+#endif
 
 using Clock = std::chrono::steady_clock;
 
-struct Edge
+enum class Engine
 {
-    int to;
-    int weight;
+    Parallel,
+    Delta,
+    Bidirectional,
+    AStar,
+    Alt,
+    Ch,
+    Compressed,
+    Gpu,
 };
 
-using Graph = std::vector<std::vector<Edge>>;
-
-bool read_dimacs_gr(const std::string &filename, Graph &graph, int &n_nodes)
+bool parse_engine(const std::string &name, Engine &engine)
 {
-    std::ifstream in(filename);
-    if (!in)
-    {
-        std::cerr << "Could not open file " << filename << "\n";
+    if (name == "parallel")
+        engine = Engine::Parallel;
+    else if (name == "delta")
+        engine = Engine::Delta;
+    else if (name == "bidir")
+        engine = Engine::Bidirectional;
+    else if (name == "astar")
+        engine = Engine::AStar;
+    else if (name == "alt")
+        engine = Engine::Alt;
+    else if (name == "ch")
+        engine = Engine::Ch;
+    else if (name == "compressed")
+        engine = Engine::Compressed;
+    else if (name == "gpu")
+        engine = Engine::Gpu;
+    else
         return false;
-    }
+    return true;
+}
 
-    std::string line;
-    int m_edges = 0;
-    n_nodes = 0;
+long long ms_between(Clock::time_point start, Clock::time_point end)
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+}
+
+// Single runs are too short for millisecond ticks on small graphs; see
+// bench_suite for repeated measurements.
+double elapsed_ms(Clock::time_point start, Clock::time_point end)
+{
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
 
-    while (std::getline(in, line))
+int main(int argc, char **argv)
+{
+    bool use_cache = true;
+    QueueKind queue = QueueKind::Auto;
+    Engine engine = Engine::Parallel;
+    long long delta = 0;
+    std::string batch_file;
+    std::string updates_file;
+    std::string out_of_core_dir;
+    double validate_fraction = 0;
+    std::uint64_t validate_seed = 0;
+    bool full = false;
+    std::string coords_file;
+    int n_landmarks = 16;
+    std::string alt_file;
+    std::string ch_file;
+    ReorderKind reorder = ReorderKind::None;
+    long long threshold = 0;
+    bool recalibrate = false;
+    int threads_option = 0;
+    double tree_cache_mb = 0;
+    NumaMode numa = NumaMode::Off;
+    std::vector<std::string> args;
+    bool bad_args = false;
+    for (int i = 1; i < argc; ++i)
     {
-        if (line.empty() || line[0] == 'c')
-            continue;
+        std::string arg = argv[i];
+        if (arg == "--no-cache")
+            use_cache = false;
+        else if (arg == "--queue" && i + 1 < argc)
+            bad_args |= !parse_queue_kind(argv[++i], queue);
+        else if (arg == "--engine" && i + 1 < argc)
+            bad_args |= !parse_engine(argv[++i], engine);
+        else if (arg == "--delta" && i + 1 < argc)
+            bad_args |= !parse_number(argv[++i], delta);
+        else if (arg == "--full")
+            full = true;
+        else if (arg == "--coords" && i + 1 < argc)
+            coords_file = argv[++i];
+        else if (arg == "--landmarks" && i + 1 < argc)
+            bad_args |= !parse_number(argv[++i], n_landmarks) || n_landmarks < 1;
+        else if (arg == "--alt-file" && i + 1 < argc)
+            alt_file = argv[++i];
+        else if (arg == "--reorder" && i + 1 < argc)
+            bad_args |= !parse_reorder_kind(argv[++i], reorder);
+        else if (arg == "--ch-file" && i + 1 < argc)
+            ch_file = argv[++i];
+        else if (arg == "--threshold" && i + 1 < argc)
+            bad_args |= !parse_number(argv[++i], threshold);
+        else if (arg == "--threads" && i + 1 < argc)
+            bad_args |= !parse_number(argv[++i], threads_option);
+        else if (arg == "--numa" && i + 1 < argc)
+            bad_args |= !parse_numa_mode(argv[++i], numa);
+        else if (arg == "--tree-cache" && i + 1 < argc)
+            bad_args |= !parse_number(argv[++i], tree_cache_mb);
+        else if (arg == "--calibrate")
+            recalibrate = true;
+        else if (arg == "--validate")
+            validate_fraction = 1.0;
+        else if (arg == "--validate-sample" && i + 1 < argc)
+            bad_args |= !parse_number(argv[++i], validate_fraction) || !(validate_fraction > 0 && validate_fraction <= 1);
+        else if (arg == "--validate-seed" && i + 1 < argc)
+            bad_args |= !parse_number(argv[++i], validate_seed);
+        else if (arg == "--out-of-core" && i + 1 < argc)
+            out_of_core_dir = argv[++i];
+        else if (arg == "--updates" && i + 1 < argc)
+            updates_file = argv[++i];
+        else if (arg == "--batch" && i + 1 < argc)
+            batch_file = argv[++i];
+        else
+            args.push_back(arg);
+    }
 
-        if (line[0] == 'p')
-        {
-            std::stringstream ss(line);
-            char p;
-            std::string type;
-            ss >> p >> type >> n_nodes >> m_edges;
-            graph.assign(n_nodes + 1, {});
-        }
-        else if (line[0] == 'a')
+    bool batch = !batch_file.empty();
+    // Trees are validated whole, so tree engines run without early exit.
+    bool validate = validate_fraction > 0;
+    if (validate && (engine == Engine::Parallel || engine == Engine::Delta || engine == Engine::Compressed ||
+                     engine == Engine::Gpu))
+        full = true;
+    // The out-of-core run keeps the mapped graph as it is and has no
+    // in-RAM tree to validate, update or batch against.
+    if (!out_of_core_dir.empty())
+    {
+        const char *conflict = engine != Engine::Parallel     ? "--engine"
+                               : reorder != ReorderKind::None ? "--reorder"
+                               : numa != NumaMode::Off        ? "--numa"
+                               : validate                     ? "--validate"
+                               : !updates_file.empty()        ? "--updates"
+                               : batch                        ? "--batch"
+                                                              : nullptr;
+        if (conflict)
         {
-            std::stringstream ss(line);
-            char a;
-            int u, v, w;
-            ss >> a >> u >> v >> w;
-            graph[u].push_back({v, w});
+            std::cerr << "--out-of-core cannot be combined with " << conflict << "\n";
+            return 1;
         }
     }
-    return true;
-}
-
-struct DijkstraResult
-{
-    std::vector<long long> dist;
-    std::vector<int> parent;
-};
+#ifndef DIJKSTRA_GPU
+    if (engine == Engine::Gpu)
+    {
+        std::cerr << "The gpu engine is not built in (configure with -DDIJKSTRA_CUDA=ON and run dijkstra_gpu)\n";
+        return 1;
+    }
+#endif
+    int target = 0;
+    bad_args |= !batch && args.size() >= 2 && !parse_number(args[1], target);
+    if (bad_args || args.size() < (batch ? 1u : 2u))
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--no-cache] [--queue auto|binary|dary|pairing|radix|dial] [--engine parallel|delta|bidir|astar|alt|ch|compressed|gpu]"
+                     " [--delta N] [--coords graph.co] [--landmarks K] [--alt-file path] [--ch-file path]"
+                     " [--reorder none|bfs|hilbert] [--threshold N] [--calibrate] [--threads N] [--numa off|pin|interleave]"
+                     " [--full] [--validate | --validate-sample F] [--validate-seed S]"
+                     " [--updates changes.txt] [--out-of-core dir]"
+                     " <graph.gr|graph.csr> <target_node>\n"
+                  << "       " << argv[0] << " [--no-cache] [--queue ...] [--reorder ...] [--threads N] [--numa ...] [--tree-cache MB] [--engine gpu] --batch <pairs.txt|-> <graph.gr|graph.csr>\n";
+        return 1;
+    }
 
-DijkstraResult dijkstra_sequential(const Graph &graph, int source)
-{
-    const long long INF = std::numeric_limits<long long>::max() / 4;
-    int n = (int)graph.size() - 1;
+    std::string filename = args[0];
 
-    std::vector<long long> dist(n + 1, INF);
-    std::vector<int> parent(n + 1, -1);
+    // Batch mode keeps stdout for results only.
+    std::ostream &info = batch ? std::cerr : std::cout;
 
-    using PQItem = std::pair<long long, int>;
-    std::priority_queue<PQItem, std::vector<PQItem>, std::greater<PQItem>> pq;
+    int num_threads = resolve_thread_count(threads_option);
+    tbb::global_control gc(tbb::global_control::max_allowed_parallelism, num_threads);
 
-    dist[source] = 0;
-    pq.push({0, source});
+    info << "Reading graph from " << filename << "...\n";
 
-    while (!pq.empty())
+    CsrGraph graph;
+    int n_nodes = 0;
+    LoadStats load;
+    if (!load_graph(filename, graph, n_nodes, &load, use_cache))
     {
-        auto [d, u] = pq.top();
-        pq.pop();
-
-        if (d != dist[u])
-            continue;
+        return 1;
+    }
+    info << "Loaded " << n_nodes << " nodes, " << graph.num_edges() << " arcs in " << load.seconds * 1000.0
+         << " ms (" << load.mb_per_s() << " MB/s, " << load.arcs_per_s() << " arcs/s"
+         << (load.cached ? ", binary cache" : "") << ")\n";
+    if (!batch && (target < 1 || target > n_nodes))
+    {
+        std::cerr << "Target node " << target << " out of range\n";
+        return 1;
+    }
 
-        for (const auto &e : graph[u])
+    // Coordinates default to the DIMACS sibling "<name>.co" of a "<name>.gr".
+    std::vector<Coord> coords;
+    bool have_coords = false;
+    if (engine == Engine::AStar || engine == Engine::Alt || reorder == ReorderKind::Hilbert)
+    {
+        std::string path = coords_file;
+        if (path.empty() && filename.size() > 3 && filename.compare(filename.size() - 3, 3, ".gr") == 0)
         {
-            long long new_dist = d + e.weight;
-            if (new_dist < dist[e.to])
-            {
-                dist[e.to] = new_dist;
-                parent[e.to] = u;
-                pq.push({new_dist, e.to});
-            }
+            path = filename.substr(0, filename.size() - 3) + ".co";
+            if (!std::filesystem::exists(path))
+                path.clear();
+        }
+        if (!path.empty())
+        {
+            if (!read_dimacs_co(path, n_nodes, coords))
+                return 1;
+            have_coords = true;
+            info << "Read coordinates from " << path << "\n";
+        }
+        else if (engine == Engine::AStar || reorder == ReorderKind::Hilbert)
+        {
+            std::cerr << (engine == Engine::AStar ? "The astar engine" : "Hilbert reordering")
+                      << " needs coordinates (--coords graph.co)\n";
+            return 1;
         }
     }
 
-    return {std::move(dist), std::move(parent)};
-}
-
-DijkstraResult dijkstra_parallel(const Graph &graph, int source)
-{
-    const long long INF = std::numeric_limits<long long>::max() / 4;
-    const size_t THRESHOLD = 100;
-    int n = (int)graph.size() - 1;
-
-    std::vector<long long> dist(n + 1, INF);
-    std::vector<int> parent(n + 1, -1);
-
-    using PQItem = std::pair<long long, int>;
-    std::priority_queue<PQItem, std::vector<PQItem>, std::greater<PQItem>> pq;
+    // Searches run on the renumbered graph; ids are mapped on the way in and
+    // out, so the CLI keeps speaking the file's numbering. Sidecar files get
+    // the ordering in their name since they depend on it.
+    NodeOrder order;
+    if (reorder != ReorderKind::None)
+    {
+        auto o1 = Clock::now();
+        order = reorder == ReorderKind::Hilbert ? hilbert_order(coords) : bfs_order(graph);
+        graph = permute_graph(graph, order);
+        if (have_coords)
+            coords = permute_nodes(coords, order);
+        info << "Reordered nodes (" << reorder_kind_name(reorder) << ") in " << ms_between(o1, Clock::now())
+             << " ms\n";
+
+        std::string suffix = std::string(".") + reorder_kind_name(reorder);
+        if (alt_file.empty())
+            alt_file = alt_file_path(filename + suffix);
+        if (ch_file.empty())
+            ch_file = ch_file_path(filename + suffix);
+    }
 
-    dist[source] = 0;
-    pq.push({0, source});
+    int source = order.to_new(1);
+    int file_target = target;
+    target = order.to_new(target);
 
-    struct Update
+    // Interleaving rebinds the final (reordered) arrays; pinning replicates
+    // them per node once the engine that uses the domains is known.
+    if (numa == NumaMode::Interleave)
     {
-        int node;
-        long long dist;
-        int prev;
-    };
+        std::vector<int> nodes = numa_node_ids();
+        if (nodes.size() < 2)
+            info << "NUMA: single node, interleaving skipped\n";
+        else if (interleave_graph(graph, nodes))
+            info << "NUMA: graph interleaved over " << nodes.size() << " nodes\n";
+        else
+            std::cerr << "Warning: could not interleave graph memory\n";
+    }
 
-    while (!pq.empty())
+    std::vector<ExecutionDomain> domains;
+    if (batch || engine == Engine::Parallel || engine == Engine::Delta)
     {
-        auto [d, u] = pq.top();
-        pq.pop();
+        auto n1 = Clock::now();
+        domains = make_execution_domains(graph, num_threads, numa);
+        if (numa == NumaMode::Pin && domains.size() < 2)
+            info << "NUMA: single node, pinning skipped\n";
+        else if (numa == NumaMode::Pin)
+            info << "NUMA: " << describe(domains) << " (graph replicated in " << ms_between(n1, Clock::now())
+                 << " ms)\n";
+    }
 
-        if (d != dist[u])
-            continue;
+    QueueKind requested = queue;
+    queue = resolve_queue_kind(queue, graph.max_weight());
+    info << "Priority queue: " << queue_kind_name(queue)
+         << (requested == QueueKind::Auto ? " (auto, max weight " + std::to_string(graph.max_weight()) + ")" : "")
+         << "\n";
 
-        const auto &edges = graph[u];
-        if (edges.empty())
-            continue;
+    // The serial/parallel crossover is measured once per machine and cached;
+    // --threshold overrides it.
+    if (engine == Engine::Parallel && !batch && out_of_core_dir.empty())
+    {
+        auto &tuning = parallel_relax_tuning();
+        if (threshold > 0)
+            tuning = {(std::size_t)threshold, std::max<std::size_t>(1, (std::size_t)threshold / 2), "option"};
+        else
+        {
+            auto c1 = Clock::now();
+            tuning = domains[0].arena->execute([&]
+                                               { return tune_parallel_relax(recalibrate); });
+            if (tuning.origin == "calibrated")
+                info << "Calibrated parallel relaxation in " << ms_between(c1, Clock::now()) << " ms\n";
+        }
+        info << "Parallel relaxation threshold: " << describe(tuning) << "\n";
+    }
 
-        if (edges.size() < THRESHOLD)
+    if (batch)
+    {
+        std::vector<QueryPair> queries;
+        std::ifstream batch_in;
+        if (batch_file != "-")
         {
-            for (const auto &e : edges)
+            batch_in.open(batch_file);
+            if (!batch_in)
             {
-                long long new_dist = d + e.weight;
-                if (new_dist < dist[e.to])
-                {
-                    dist[e.to] = new_dist;
-                    parent[e.to] = u;
-                    pq.push({new_dist, e.to});
-                }
+                std::cerr << "Could not open file " << batch_file << "\n";
+                return 1;
             }
         }
-        else
+        if (!read_query_pairs(batch_file == "-" ? std::cin : batch_in, n_nodes, queries))
+            return 1;
+
+        std::vector<QueryPair> mapped = queries;
+        for (auto &q : mapped)
+            q = {order.to_new(q.source), order.to_new(q.target)};
+
+        // Sources that repeat are answered from cached shortest-path trees.
+        std::unique_ptr<SourceTreeCache> tree_cache;
+        if (tree_cache_mb > 0)
+            tree_cache = std::make_unique<SourceTreeCache>((std::size_t)(tree_cache_mb * 1024 * 1024));
+
+        std::vector<long long> distances;
+        BatchStats stats;
+        std::string ran_on;
+#ifdef DIJKSTRA_GPU
+        if (engine == Engine::Gpu)
         {
-            std::vector<Update> updates;
-            std::mutex mtx;
-
-            tbb::parallel_for(size_t(0), edges.size(), [&](size_t i)
-                              {
-                const auto &e = edges[i];
-                long long new_dist = d + e.weight;
+            auto gpu = make_gpu_sssp(graph);
+            if (!gpu || !run_batch_gpu(*gpu, graph, mapped, distances, stats, delta))
+                return 1;
+            ran_on = gpu->device_name() + ", batch " + std::to_string(gpu->max_batch());
+        }
+#endif
+        if (engine != Engine::Gpu)
+        {
+            stats = with_queue(queue, [&]<template <typename> class Q>()
+                               { return run_batch<Q>(domains, mapped, distances, tree_cache.get()); });
+            ran_on = describe(domains);
+        }
 
-                if (new_dist < dist[e.to]) {
-                    std::lock_guard<std::mutex> lock(mtx);
-                    updates.push_back({e.to, new_dist, u});
-                } });
+        for (std::size_t i = 0; i < queries.size(); ++i)
+        {
+            std::cout << queries[i].source << " " << queries[i].target << " ";
+            if (distances[i] >= DIST_INF)
+                std::cout << "inf\n";
+            else
+                std::cout << distances[i] << "\n";
+        }
 
-            for (const auto &upd : updates)
-            {
-                if (upd.dist < dist[upd.node])
-                {
-                    dist[upd.node] = upd.dist;
-                    parent[upd.node] = upd.prev;
-                    pq.push({upd.dist, upd.node});
-                }
-            }
+        info << "Batch: " << stats.queries << " queries in " << stats.seconds * 1000.0 << " ms ("
+             << stats.queries_per_s() << " queries/s, " << ran_on << ")\n";
+        info << "Latency: p50 " << stats.p50_us << " us, p99 " << stats.p99_us << " us\n";
+        if (tree_cache)
+        {
+            print_search_stats(info, "Tree cache", tree_cache->stats());
+            info << "Tree cache memory: " << tree_cache->trees() << " trees, "
+                 << tree_cache->bytes() / (1024.0 * 1024.0) << " of " << tree_cache->budget() / (1024.0 * 1024.0)
+                 << " MB\n";
         }
+        return 0;
     }
 
-    return {std::move(dist), std::move(parent)};
-}
+    // External-memory run: labels go to a file under the given directory and
+    // the mapped graph is read ahead partition by partition; nothing else is
+    // kept per node, so the in-RAM comparison run is skipped as well.
+    if (!out_of_core_dir.empty())
+    {
+        ExternalLabels labels;
+        if (!labels.open(out_of_core_dir, n_nodes))
+            return 1;
+        std::span<const int> stop_at;
+        if (!full)
+            stop_at = {&target, 1};
+        // The indexed queues keep an entry per node; the others only grow
+        // with the frontier.
+        QueueKind kind = queue == QueueKind::Dary || queue == QueueKind::Pairing ? QueueKind::Binary : queue;
+        auto x1 = Clock::now();
+        std::size_t settled;
+        {
+            PartitionPrefetcher prefetch(graph);
+            settled = with_queue(kind, [&]<template <typename> class Q>()
+                                 { return dijkstra_out_of_core<Q>(graph, source, labels, stop_at, &prefetch); });
+            info << "Out-of-core search (" << queue_kind_name(kind) << " queue): " << settled
+                 << " nodes settled in " << elapsed_ms(x1, Clock::now()) << " ms (" << prefetch.partitions()
+                 << " partitions prefetched, " << labels.bytes() / (1024.0 * 1024.0) << " MB of labels in "
+                 << out_of_core_dir << ")\n";
+        }
 
-long long ms_between(Clock::time_point start, Clock::time_point end)
-{
-    return std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-}
+        PathResult answer = extract_path(labels, target);
+        std::cout << "\nShortest Path from " << order.to_old(source) << " to " << file_target << ":\n";
+        if (answer.distance >= DIST_INF)
+        {
+            std::cout << "Target is unreachable\n";
+            return 0;
+        }
+        std::cout << "Distance: " << answer.distance << "\nPath: ";
+        for (int v : answer.path)
+            std::cout << order.to_old(v) << " ";
+        std::cout << "\n";
+        return 0;
+    }
 
-int main(int argc, char **argv)
-{
-    if (argc < 3)
+    // Weight changes repair the full tree from the source instead of
+    // searching again; the repaired tree is checked against a recomputation.
+    if (!updates_file.empty())
     {
-        std::cerr << "Usage: " << argv[0] << " <graph.gr> <target_node>\n";
-        return 1;
+        std::ifstream updates_in(updates_file);
+        if (!updates_in)
+        {
+            std::cerr << "Could not open file " << updates_file << "\n";
+            return 1;
+        }
+        std::vector<WeightChange> changes;
+        if (!read_weight_changes(updates_in, n_nodes, changes))
+            return 1;
+        for (auto &c : changes)
+            c = {order.to_new(c.from), order.to_new(c.to), c.weight};
+
+        DynamicGraph dynamic(graph);
+        auto i1 = Clock::now();
+        DynamicShortestPaths tree(dynamic, source);
+        auto i2 = Clock::now();
+        long long before = tree.dist(target);
+        auto arcs = dynamic.apply(changes);
+        auto u1 = Clock::now();
+        RepairStats repair = tree.repair(dynamic, arcs);
+        auto u2 = Clock::now();
+        // Raised weights can rule out the queue picked for the original
+        // graph (Dial allocates a bucket per weight value).
+        QueueKind recompute_queue = resolve_queue_kind(requested, dynamic.graph().max_weight());
+        auto fresh = with_queue(recompute_queue, [&]<template <typename> class Q>()
+                                { return dijkstra_sequential<Q>(dynamic.graph(), source); });
+        auto u3 = Clock::now();
+
+        auto print_dist = [](long long d)
+        { return d >= DIST_INF ? std::string("inf") : std::to_string(d); };
+        std::cout << "\nDynamic Update Results:\n";
+        std::cout << "Initial tree time: " << elapsed_ms(i1, i2) << " ms\n";
+        std::cout << "Changes: " << changes.size() << " requested, " << arcs.size() << " arcs changed\n";
+        std::cout << "Repair time: " << elapsed_ms(u1, u2) << " ms (" << repair.invalidated << " invalidated, "
+                  << repair.settled << " settled, " << repair.arcs_scanned << " arcs)\n";
+        std::cout << "Recompute time: " << elapsed_ms(u2, u3) << " ms\n";
+        std::cout << "Distances match recompute: " << (std::ranges::equal(tree.dist(), fresh.dist) ? "yes" : "NO")
+                  << "\n";
+        std::cout << "Distance from " << order.to_old(source) << " to " << file_target << ": " << print_dist(before)
+                  << " -> " << print_dist(tree.dist(target)) << "\n";
+        return 0;
     }
 
-    std::string filename = argv[1];
-    int target = std::stoi(argv[2]);
+    // Point-to-point by default: stop once the target is settled.
+    std::span<const int> stop_at;
+    if (!full)
+        stop_at = {&target, 1};
 
-    std::cout << "Reading graph from " << filename << "...\n";
+    auto t1 = Clock::now();
+    auto res_seq = with_queue(queue, [&]<template <typename> class Q>()
+                              { return dijkstra_sequential<Q>(graph, source, stop_at); });
+    auto t2 = Clock::now();
+    double ms_seq = elapsed_ms(t1, t2);
 
-    Graph graph;
-    int n_nodes = 0;
-    if (!read_dimacs_gr(filename, graph, n_nodes))
+    if (delta <= 0)
+        delta = default_delta(graph);
+
+    CsrGraph reverse;
+    if (engine == Engine::Bidirectional || engine == Engine::Alt)
     {
-        return 1;
+        auto r1 = Clock::now();
+        reverse = reverse_graph(graph);
+        info << "Built reverse graph in " << ms_between(r1, Clock::now()) << " ms\n";
     }
-    std::cout << "Loaded " << n_nodes << " nodes\n";
 
-    int source = 1;
-    int num_threads = 10;
-    tbb::global_control gc(tbb::global_control::max_allowed_parallelism, num_threads);
+    std::optional<CoordinateBounds> euclid;
+    if (engine == Engine::AStar)
+    {
+        euclid.emplace(graph, std::move(coords));
+        info << "Euclidean bound scale: " << euclid->scale() << " per coordinate unit\n";
+    }
 
-    auto t1 = Clock::now();
-    auto res_seq = dijkstra_sequential(graph, source);
-    auto t2 = Clock::now();
-    auto ms_seq = ms_between(t1, t2);
+    // Landmark tables are reused from "<graph>.alt" while the graph file is
+    // unchanged and rebuilt otherwise.
+    AltTables alt;
+    if (engine == Engine::Alt)
+    {
+        if (alt_file.empty())
+            alt_file = alt_file_path(filename);
+        SourceStamp stamp;
+        stat_source(filename, stamp);
+        if (AltTables::map(alt_file, graph, stamp, n_landmarks, alt))
+            info << "Mapped " << alt.num_landmarks() << " landmarks from " << alt_file << "\n";
+        else
+        {
+            auto a1 = Clock::now();
+            alt = AltTables::build(graph, reverse, select_landmarks(graph, n_landmarks, have_coords ? &coords : nullptr));
+            info << "Built " << alt.num_landmarks() << " landmarks in " << ms_between(a1, Clock::now()) << " ms\n";
+            if (!alt.write(alt_file, graph, stamp))
+                std::cerr << "Warning: could not write landmark file " << alt_file << "\n";
+        }
+    }
+
+    // Like the landmark tables, the hierarchy is kept in "<graph>.ch".
+    ContractionHierarchy ch;
+    if (engine == Engine::Ch)
+        load_contraction_hierarchy(filename, graph, ch_file, ch, info);
+
+    CompressedGraph compressed;
+    if (engine == Engine::Compressed)
+    {
+        auto z1 = Clock::now();
+        if (!CompressedGraph::build(graph, compressed))
+            return 1;
+        info << "Compressed adjacency in " << ms_between(z1, Clock::now()) << " ms: "
+             << compressed.bytes() / (1024.0 * 1024.0) << " MB vs " << csr_bytes(graph) / (1024.0 * 1024.0)
+             << " MB CSR (" << compressed.weight_bytes() << "-byte weights)\n";
+    }
+
+#ifdef DIJKSTRA_GPU
+    // Uploading the graph is setup, like building the other indexes.
+    std::unique_ptr<GpuSssp> gpu;
+    if (engine == Engine::Gpu)
+    {
+        auto g1 = Clock::now();
+        gpu = make_gpu_sssp(graph);
+        if (!gpu)
+            return 1;
+        info << "Uploaded graph to " << gpu->device_name() << " in " << ms_between(g1, Clock::now())
+             << " ms (batch " << gpu->max_batch() << ")\n";
+    }
+#endif
 
     auto t3 = Clock::now();
-    auto res_par = dijkstra_parallel(graph, source);
+    DijkstraResult res_par;
+    PathResult answer;
+    std::string engine_label;
+    switch (engine)
+    {
+    // A single search cannot span sockets usefully, so with pinning it runs
+    // on the first node's workers and graph replica.
+    case Engine::Parallel:
+        res_par = domains[0].arena->execute([&]
+                                            { return with_queue(queue, [&]<template <typename> class Q>()
+                                                                { return dijkstra_parallel<Q>(domains[0].graph, source, stop_at); }); });
+        engine_label = "Parallel (" + std::to_string(domains[0].threads) + " threads)";
+        break;
+    case Engine::Delta:
+        res_par = domains[0].arena->execute([&]
+                                            { return delta_stepping(domains[0].graph, source, delta, stop_at); });
+        engine_label = "Delta-stepping (delta " + std::to_string(delta) + ", " + std::to_string(domains[0].threads) +
+                       " threads)";
+        break;
+    case Engine::Bidirectional:
+        answer = with_queue(queue, [&]<template <typename> class Q>()
+                            { return bidirectional_dijkstra<Q>(graph, reverse, source, target); });
+        engine_label = "Bidirectional";
+        break;
+    case Engine::AStar:
+        answer = astar(graph, source, target, [&](int v)
+                       { return euclid->bound(v, target); });
+        engine_label = "A* (Euclidean)";
+        break;
+    case Engine::Alt:
+        answer = astar(graph, source, target, [&](int v)
+                       { return alt.bound(v, target); });
+        engine_label = "ALT (" + std::to_string(alt.num_landmarks()) + " landmarks)";
+        break;
+    case Engine::Ch:
+        answer = ch_query(ch, source, target);
+        engine_label = "Contraction hierarchy query";
+        break;
+    case Engine::Compressed:
+        res_par = with_queue(queue, [&]<template <typename> class Q>()
+                             { return dijkstra_compressed<Q>(compressed, source, stop_at); });
+        engine_label = "Compressed adjacency";
+        break;
+    case Engine::Gpu:
+#ifdef DIJKSTRA_GPU
+    {
+        // Always a full tree; stop_at does not apply.
+        auto trees = gpu_sssp(*gpu, graph, {&source, 1}, delta);
+        if (trees.empty())
+            return 1;
+        res_par = std::move(trees[0]);
+        engine_label = "GPU near-far (" + gpu->device_name() + ")";
+    }
+#endif
+        break;
+    }
     auto t4 = Clock::now();
-    auto ms_par = ms_between(t3, t4);
+    double ms_par = elapsed_ms(t3, t4);
+
+    // Engines producing a full tree are compared on dist arrays; the
+    // point-to-point ones only on the answer.
+    bool has_tree = !res_par.dist.empty();
+    if (has_tree)
+        answer = extract_path(res_par, target);
 
     std::cout << "\nPerformance Results:\n";
     std::cout << "Sequential time: " << ms_seq << " ms\n";
-    std::cout << "Parallel (" << num_threads << " threads) time: " << ms_par << " ms\n";
-
-    double speedup = (ms_par > 0) ? (double)ms_seq / (double)ms_par : 0.0;
-    double efficiency = (ms_par > 0) ? speedup / num_threads : 0.0;
+    std::cout << engine_label << " time: " << ms_par << " ms\n";
+    bool compare_all = full && has_tree;
+    bool match = compare_all ? res_par.dist == res_seq.dist : answer.distance == res_seq.dist[target];
+    std::cout << (compare_all ? "Distances" : "Target distance") << " match sequential: " << (match ? "yes" : "NO")
+              << "\n";
+
+    double speedup = (ms_par > 0) ? ms_seq / ms_par : 0.0;
+    double efficiency = (ms_par > 0) ? speedup / (domains.empty() ? num_threads : domains[0].threads) : 0.0;
     std::cout << "Speedup: " << speedup << "x\n";
     std::cout << "Efficiency: " << efficiency << "\n";
 
-    std::cout << "\nShortest Path from " << source << " to " << target << ":\n";
-    std::cout << "Distance: " << res_par.dist[target] << "\n";
-    std::cout << "Path: ";
+    // Both trees are certified on their own (tight parent arcs, no improving
+    // arc), and the engine's against the sequential distances as well.
+    bool valid = true;
+    if (validate)
+    {
+        std::cout << "\nValidation:\n";
+        auto v1 = Clock::now();
+        auto report = [&](const char *label, ValidationReport r)
+        {
+            for (int &v : r.examples)
+                v = order.to_old(v);
+            print_validation(std::cout, label, r, n_nodes);
+            valid &= r.ok();
+        };
+        if (full)
+        {
+            report("Sequential", validate_tree(graph, source, res_seq, nullptr, validate_fraction, validate_seed));
+            if (validate_fraction < 1)
+                std::cout << "(sampled without a reference: does not certify the sequential tree)\n";
+        }
+        if (has_tree)
+            report(engine_label.c_str(),
+                   validate_tree(graph, source, res_par, &res_seq, validate_fraction, validate_seed));
+        else
+        {
+            bool path_ok = validate_path(graph, source, target, answer, res_seq.dist[target]);
+            std::cout << engine_label << ": path and distance " << (path_ok ? "OK" : "FAILED") << "\n";
+            valid &= path_ok;
+        }
+        std::cout << "Validated in " << elapsed_ms(v1, Clock::now()) << " ms\n";
+    }
 
-    std::vector<int> path;
-    for (int v = target; v != -1; v = res_par.parent[v])
+    if constexpr (SEARCH_STATS_ENABLED)
     {
-        path.push_back(v);
+        std::cout << "\nSearch counters:\n";
+        print_search_stats(std::cout, "Sequential", res_seq.stats);
+        if (has_tree)
+            print_search_stats(std::cout, engine_label.c_str(), res_par.stats);
     }
-    std::reverse(path.begin(), path.end());
 
-    for (int v : path)
-        std::cout << v << " ";
+    std::cout << "\nShortest Path from " << order.to_old(source) << " to " << file_target << ":\n";
+    if (answer.distance >= DIST_INF)
+    {
+        std::cout << "Target is unreachable\n";
+        return valid ? 0 : 2;
+    }
+    std::cout << "Distance: " << answer.distance << "\n";
+    if (answer.settled)
+        std::cout << "Settled nodes: " << answer.settled << "\n";
+    std::cout << "Path: ";
+
+    for (int v : answer.path)
+        std::cout << order.to_old(v) << " ";
     std::cout << "\n";
 
-    return 0;
+    return valid ? 0 : 2;
 }
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Read-only private mapping of a whole file, unmapped on destruction.
+class MappedFile
+{
+public:
+    MappedFile(void *data, std::size_t size) : data_(data), size_(size) {}
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile()
+    {
+        if (data_)
+            ::munmap(data_, size_);
+    }
+
+    const char *data() const { return (const char *)data_; }
+    std::size_t size() const { return size_; }
+
+    void advise(int advice) const { ::madvise(data_, size_, advice); }
+
+private:
+    void *data_;
+    std::size_t size_;
+};
+
+inline std::shared_ptr<MappedFile> map_file(const std::string &path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        ::close(fd);
+        return nullptr;
+    }
+
+    void *data = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+        return nullptr;
+    return std::make_shared<MappedFile>(data, (std::size_t)st.st_size);
+}
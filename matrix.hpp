@@ -0,0 +1,193 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+
+#include "ch.hpp"
+#include "dijkstra.hpp"
+#include "graph.hpp"
+#include "graph_cache.hpp"
+#include "heaps.hpp"
+
+// Reads whitespace-separated node ids; '#' starts a comment to end of line.
+inline bool read_node_list(std::istream &in, int n_nodes, std::vector<int> &nodes)
+{
+    std::string line;
+    std::size_t line_no = 0;
+    while (std::getline(in, line))
+    {
+        ++line_no;
+        std::istringstream ss(line.substr(0, line.find('#')));
+        std::string token;
+        while (ss >> token)
+        {
+            int v = 0;
+            try
+            {
+                v = std::stoi(token);
+            }
+            catch (...)
+            {
+                v = 0;
+            }
+            if (v < 1 || v > n_nodes)
+            {
+                std::cerr << "Invalid node id at line " << line_no << ": " << token << "\n";
+                return false;
+            }
+            nodes.push_back(v);
+        }
+    }
+    return true;
+}
+
+// Row-major sources x targets distances; DIST_INF where unreachable.
+struct DistanceMatrix
+{
+    std::vector<int> sources;
+    std::vector<int> targets;
+    std::vector<long long> dist;
+
+    long long at(std::size_t i, std::size_t j) const { return dist[i * targets.size() + j]; }
+};
+
+// One search per source on the TBB pool, each in a per-worker workspace and
+// stopped once every target is settled.
+template <template <typename> class Queue>
+DistanceMatrix distance_matrix(const CsrGraph &graph, std::vector<int> sources, std::vector<int> targets)
+{
+    DistanceMatrix m{std::move(sources), std::move(targets), {}};
+    const std::size_t cols = m.targets.size();
+    m.dist.assign(m.sources.size() * cols, DIST_INF);
+    if (cols == 0)
+        return m;
+
+    tbb::enumerable_thread_specific<QueryWorkspace<Queue>> workspaces(graph, false);
+    tbb::parallel_for(std::size_t(0), m.sources.size(), [&](std::size_t i)
+                      {
+        auto &ws = workspaces.local();
+        dijkstra_sequential(graph, m.sources[i], ws, m.targets);
+        long long *row = m.dist.data() + i * cols;
+        for (std::size_t j = 0; j < cols; ++j)
+            row[j] = ws.dist(m.targets[j]); });
+    return m;
+}
+
+// Bucket-based many-to-many on a contraction hierarchy. A backward upward
+// search from every target leaves (target, distance) entries in the buckets
+// of the nodes it settles. A forward upward search from each source then
+// scans the buckets of its settled nodes, since every shortest path has a
+// highest node reached by both. Both phases run in parallel; the buckets
+// are packed into CSR between them.
+inline DistanceMatrix ch_distance_matrix(const ContractionHierarchy &ch, std::vector<int> sources,
+                                         std::vector<int> targets)
+{
+    DistanceMatrix m{std::move(sources), std::move(targets), {}};
+    const int n = ch.num_nodes();
+    const std::size_t cols = m.targets.size();
+    m.dist.assign(m.sources.size() * cols, DIST_INF);
+
+    struct Entry
+    {
+        int node;
+        int column;
+        long long dist;
+    };
+    tbb::enumerable_thread_specific<QueryWorkspace<QuaternaryHeap>> workspaces(n, 0, false);
+    tbb::enumerable_thread_specific<std::vector<Entry>> entries;
+    tbb::parallel_for(std::size_t(0), cols, [&](std::size_t j)
+                      {
+        auto &out = entries.local();
+        ch_upward_search(ch.down(), ch.up(), m.targets[j], workspaces.local(), [&](int v, long long d)
+                         { out.push_back({v, (int)j, d}); }); });
+
+    struct BucketEntry
+    {
+        int column;
+        long long dist;
+    };
+    std::vector<std::uint64_t> offsets(n + 2, 0);
+    for (const auto &local : entries)
+        for (const auto &e : local)
+            ++offsets[e.node + 1];
+    for (int v = 1; v <= n + 1; ++v)
+        offsets[v] += offsets[v - 1];
+    std::vector<BucketEntry> buckets(offsets[n + 1]);
+    {
+        std::vector<std::uint64_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (auto &local : entries)
+        {
+            for (const auto &e : local)
+                buckets[cursor[e.node]++] = {e.column, e.dist};
+            std::vector<Entry>().swap(local);
+        }
+    }
+
+    tbb::parallel_for(std::size_t(0), m.sources.size(), [&](std::size_t i)
+                      {
+        long long *row = m.dist.data() + i * cols;
+        ch_upward_search(ch.up(), ch.down(), m.sources[i], workspaces.local(), [&](int v, long long d)
+                         {
+            for (std::uint64_t b = offsets[v]; b < offsets[v + 1]; ++b)
+                row[buckets[b].column] = std::min(row[buckets[b].column], d + buckets[b].dist); }); });
+    return m;
+}
+
+struct DistanceMatrixHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint64_t rows;
+    std::uint64_t cols;
+};
+
+inline constexpr char DISTANCE_MATRIX_MAGIC[8] = {'D', 'J', 'K', 'M', 'A', 'T', '\0', '\0'};
+inline constexpr std::uint32_t DISTANCE_MATRIX_VERSION = 1;
+
+// Dense binary layout: the header, the int32 source ids, the int32 target
+// ids, then rows * cols int64 distances in row-major order with -1 for
+// unreachable pairs.
+inline bool write_distance_matrix(const std::string &path, const DistanceMatrix &m)
+{
+    DistanceMatrixHeader header{};
+    std::memcpy(header.magic, DISTANCE_MATRIX_MAGIC, sizeof header.magic);
+    header.version = DISTANCE_MATRIX_VERSION;
+    header.byte_order = GRAPH_CACHE_BYTE_ORDER;
+    header.rows = m.sources.size();
+    header.cols = m.targets.size();
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        std::cerr << "Could not create " << path << "\n";
+        return false;
+    }
+    out.write((const char *)&header, sizeof header);
+    out.write((const char *)m.sources.data(), m.sources.size() * sizeof(int));
+    out.write((const char *)m.targets.data(), m.targets.size() * sizeof(int));
+
+    std::vector<std::int64_t> row(m.targets.size());
+    for (std::size_t i = 0; i < m.sources.size(); ++i)
+    {
+        for (std::size_t j = 0; j < row.size(); ++j)
+            row[j] = m.at(i, j) >= DIST_INF ? -1 : m.at(i, j);
+        out.write((const char *)row.data(), row.size() * sizeof(std::int64_t));
+    }
+    if (!out.flush())
+    {
+        std::cerr << "Error writing " << path << "\n";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,255 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "dijkstra.hpp"
+#include "graph.hpp"
+#include "heaps.hpp"
+
+// External-memory single-source search for graphs whose CSR arrays (mapped
+// from a binary file, see graph_cache.hpp) and labels do not fit in RAM.
+// The graph pages are only page cache, the labels live in a file-backed
+// shared mapping the kernel can write back, and the queue should be one
+// without a per-node index (binary, radix or Dial), which only grows with
+// the frontier.
+
+inline void advise_range(const void *data, std::size_t bytes, int advice)
+{
+    if (bytes == 0)
+        return;
+    static const std::uintptr_t page = (std::uintptr_t)::sysconf(_SC_PAGESIZE);
+    std::uintptr_t begin = (std::uintptr_t)data & ~(page - 1);
+    std::uintptr_t end = (std::uintptr_t)data + bytes;
+    ::madvise((void *)begin, end - begin, advice);
+}
+
+// Labels in an unlinked temporary file under dir, mapped shared. A fresh
+// file reads as zeros, so values are stored off by one (0 = unreached) and
+// nothing needs to be initialized: untouched pages never hit the disk.
+class ExternalLabels
+{
+public:
+    ExternalLabels() = default;
+    ExternalLabels(const ExternalLabels &) = delete;
+    ExternalLabels &operator=(const ExternalLabels &) = delete;
+    ~ExternalLabels()
+    {
+        if (data_)
+            ::munmap(data_, bytes_);
+    }
+
+    // Returns false (with a message) when the file cannot be created.
+    bool open(const std::string &dir, int n, bool track_parents = true)
+    {
+        n_ = n;
+        bytes_ = (std::size_t)(n + 1) * (sizeof(std::uint64_t) + (track_parents ? sizeof(std::uint32_t) : 0));
+        std::string path = dir + "/dijkstra_labels.XXXXXX";
+        int fd = ::mkstemp(path.data());
+        if (fd < 0)
+        {
+            std::cerr << "Could not create a label file in " << dir << "\n";
+            return false;
+        }
+        ::unlink(path.c_str());
+        void *data = MAP_FAILED;
+        if (::ftruncate(fd, (off_t)bytes_) == 0)
+            data = ::mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED)
+        {
+            std::cerr << "Could not map " << bytes_ << " bytes of labels in " << dir << "\n";
+            return false;
+        }
+        data_ = data;
+        dist_ = (std::uint64_t *)data;
+        parent_ = track_parents ? (std::uint32_t *)(dist_ + n + 1) : nullptr;
+        return true;
+    }
+
+    int num_nodes() const { return n_; }
+    std::size_t bytes() const { return bytes_; }
+    bool tracks_parents() const { return parent_ != nullptr; }
+
+    long long dist(int v) const { return dist_[v] ? (long long)dist_[v] - 1 : DIST_INF; }
+    int parent(int v) const { return parent_ ? (int)parent_[v] - 1 : -1; }
+
+    void label(int v, long long d, int p)
+    {
+        dist_[v] = (std::uint64_t)d + 1;
+        if (parent_)
+            parent_[v] = (std::uint32_t)(p + 1);
+    }
+
+private:
+    void *data_ = nullptr;
+    std::size_t bytes_ = 0;
+    int n_ = 0;
+    std::uint64_t *dist_ = nullptr;
+    std::uint32_t *parent_ = nullptr;
+};
+
+inline constexpr int OUT_OF_CORE_PARTITION_NODES = 4096;
+
+// Reads ahead the CSR pages of node-ordered partitions. The search names a
+// node when it first labels it; the partition holding it is then queued once
+// and a background thread issues MADV_WILLNEED for its offsets, targets and
+// weights, so the pages are usually in by the time the node is settled.
+// Default readahead around faults is switched off (MADV_RANDOM), since on a
+// graph larger than RAM it mostly evicts pages still needed.
+class PartitionPrefetcher
+{
+public:
+    explicit PartitionPrefetcher(const CsrGraph &graph, int partition_nodes = OUT_OF_CORE_PARTITION_NODES)
+        : graph_(graph), partition_nodes_(partition_nodes),
+          requested_(graph.num_nodes() / partition_nodes + 1, 0), worker_([this]
+                                                                           { run(); })
+    {
+        advise_range(graph.offsets().data(), graph.offsets().size_bytes(), MADV_RANDOM);
+        advise_range(graph.all_targets().data(), graph.all_targets().size_bytes(), MADV_RANDOM);
+        advise_range(graph.all_weights().data(), graph.all_weights().size_bytes(), MADV_RANDOM);
+    }
+
+    PartitionPrefetcher(const PartitionPrefetcher &) = delete;
+    PartitionPrefetcher &operator=(const PartitionPrefetcher &) = delete;
+
+    ~PartitionPrefetcher()
+    {
+        {
+            std::lock_guard lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        worker_.join();
+    }
+
+    // Called from the search thread only.
+    void touch(int v)
+    {
+        std::size_t p = v / partition_nodes_;
+        if (requested_[p])
+            return;
+        requested_[p] = 1;
+        ++partitions_;
+        {
+            std::lock_guard lock(mutex_);
+            pending_.push_back(p);
+        }
+        wake_.notify_one();
+    }
+
+    std::size_t partitions() const { return partitions_; }
+
+private:
+    void run()
+    {
+        std::unique_lock lock(mutex_);
+        while (true)
+        {
+            wake_.wait(lock, [this]
+                       { return stop_ || !pending_.empty(); });
+            if (stop_)
+                return;
+            std::size_t p = pending_.front();
+            pending_.pop_front();
+            lock.unlock();
+            prefetch(p);
+            lock.lock();
+        }
+    }
+
+    void prefetch(std::size_t p)
+    {
+        int first = std::max<int>(1, (int)(p * partition_nodes_));
+        int last = std::min<int>(graph_.num_nodes(), (int)((p + 1) * partition_nodes_) - 1);
+        if (first > last)
+            return;
+        auto offsets = graph_.offsets();
+        advise_range(offsets.data() + first, (last - first + 2) * sizeof(offsets[0]), MADV_WILLNEED);
+        std::uint64_t begin = offsets[first], end = offsets[last + 1];
+        advise_range(graph_.all_targets().data() + begin, (end - begin) * sizeof(int), MADV_WILLNEED);
+        advise_range(graph_.all_weights().data() + begin, (end - begin) * sizeof(int), MADV_WILLNEED);
+    }
+
+    const CsrGraph &graph_;
+    std::size_t partition_nodes_;
+    std::vector<char> requested_;
+    std::size_t partitions_ = 0;
+    std::deque<std::size_t> pending_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+    std::thread worker_;
+};
+
+// Dijkstra over external labels (which must be fresh); stop_at as in
+// dijkstra_sequential. Returns the number of settled nodes.
+template <template <typename> class Queue = LazyBinaryHeap>
+std::size_t dijkstra_out_of_core(const CsrGraph &graph, int source, ExternalLabels &labels,
+                                 std::span<const int> stop_at = {}, PartitionPrefetcher *prefetch = nullptr)
+{
+    std::vector<char> marks;
+    TargetSet stop(stop_at, graph.num_nodes(), marks);
+    Queue<long long> pq(graph.num_nodes(), graph.max_weight());
+    std::size_t settled = 0;
+
+    labels.label(source, 0, -1);
+    pq.push_or_decrease(0, source);
+    if (prefetch)
+        prefetch->touch(source);
+
+    while (!pq.empty())
+    {
+        auto [d, u] = pq.pop();
+        if (d != labels.dist(u))
+            continue;
+        if (stop.settle(u))
+            break;
+        ++settled;
+
+        auto targets = graph.targets(u);
+        auto weights = graph.weights(u);
+        for (std::size_t i = 0; i < targets.size(); ++i)
+        {
+            int v = targets[i];
+            long long new_dist = d + weights[i];
+            long long old_dist = labels.dist(v);
+            if (!(new_dist < old_dist))
+                continue;
+            if (prefetch && old_dist == DIST_INF)
+                prefetch->touch(v);
+            labels.label(v, new_dist, u);
+            pq.push_or_decrease(new_dist, v);
+        }
+    }
+    return settled;
+}
+
+// Source-to-target path along the parents in labels.
+inline PathResult extract_path(const ExternalLabels &labels, int target)
+{
+    PathResult result;
+    if (labels.dist(target) >= DIST_INF)
+        return result;
+    result.distance = labels.dist(target);
+    if (!labels.tracks_parents())
+        return result;
+    for (int v = target; v != -1; v = labels.parent(v))
+        result.path.push_back(v);
+    std::reverse(result.path.begin(), result.path.end());
+    return result;
+}
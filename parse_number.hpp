@@ -0,0 +1,14 @@
+#pragma once
+
+#include <charconv>
+#include <string_view>
+#include <system_error>
+
+// Parses the whole of text as a number of type T. Empty input, trailing
+// characters and out-of-range values are rejected, leaving value unchanged.
+template <typename T>
+bool parse_number(std::string_view text, T &value)
+{
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return !text.empty() && ec == std::errc() && end == text.data() + text.size();
+}
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/global_control.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+
+#include "simd_relax.hpp"
+
+inline constexpr std::size_t PARALLEL_RELAX_OFF = std::numeric_limits<std::size_t>::max();
+
+// When dijkstra_parallel hands a node's arcs to tbb::parallel_for. Nodes
+// with at least `threshold` arcs are split into blocked_range chunks of at
+// least `grain` arcs; threshold PARALLEL_RELAX_OFF keeps every node serial.
+struct ParallelRelaxTuning
+{
+    std::size_t threshold = 100;
+    std::size_t grain = 64;
+    std::string origin = "default";
+
+    bool serial_only() const { return threshold == PARALLEL_RELAX_OFF; }
+};
+
+// The setting dijkstra_parallel reads; tools overwrite it at startup.
+inline ParallelRelaxTuning &parallel_relax_tuning()
+{
+    static ParallelRelaxTuning tuning;
+    return tuning;
+}
+
+inline std::size_t parallel_relax_threads()
+{
+    return std::min<std::size_t>(tbb::global_control::active_value(tbb::global_control::max_allowed_parallelism),
+                                 tbb::this_task_arena::max_concurrency());
+}
+
+// Calibration results depend on the host, the worker count and the SIMD
+// kernel in use, so all three go into the cache key.
+inline std::string parallel_relax_key()
+{
+    char host[256] = {};
+    if (gethostname(host, sizeof host - 1) != 0 || !host[0])
+        std::strcpy(host, "localhost");
+    return std::string(host) + ":threads=" + std::to_string(parallel_relax_threads()) +
+           ":simd=" + simd_level_name(simd_level());
+}
+
+// $DIJKSTRA_TUNING_FILE, else under $XDG_CACHE_HOME or ~/.cache; empty when
+// none is set.
+inline std::string parallel_relax_cache_path()
+{
+    if (const char *file = std::getenv("DIJKSTRA_TUNING_FILE"))
+        return file;
+    if (const char *xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg)
+        return std::string(xdg) + "/dijkstra_parallel/tuning.txt";
+    if (const char *home = std::getenv("HOME"); home && *home)
+        return std::string(home) + "/.cache/dijkstra_parallel/tuning.txt";
+    return {};
+}
+
+// The cache holds one "<key> <threshold> <grain>" line per machine setup.
+inline bool load_parallel_relax_tuning(const std::string &path, const std::string &key, ParallelRelaxTuning &tuning)
+{
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::istringstream fields(line);
+        std::string k;
+        ParallelRelaxTuning t;
+        if (fields >> k >> t.threshold >> t.grain && k == key && t.grain > 0)
+        {
+            t.origin = "cached";
+            tuning = t;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool save_parallel_relax_tuning(const std::string &path, const std::string &key,
+                                       const ParallelRelaxTuning &tuning)
+{
+    std::vector<std::string> kept;
+    {
+        std::ifstream in(path);
+        std::string line;
+        while (std::getline(in, line))
+            if (line.compare(0, key.size() + 1, key + " ") != 0)
+                kept.push_back(line);
+    }
+    std::error_code ec;
+    std::filesystem::path p(path);
+    if (p.has_parent_path())
+        std::filesystem::create_directories(p.parent_path(), ec);
+
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        for (const auto &line : kept)
+            out << line << "\n";
+        out << key << " " << tuning.threshold << " " << tuning.grain << "\n";
+        if (!out)
+            return false;
+    }
+    std::filesystem::rename(tmp, path, ec);
+    return !ec;
+}
+
+// Times the serial candidate scan against the blocked_range version on
+// synthetic adjacencies of growing degree, with random targets into a dist
+// array well beyond cache size. The threshold is the smallest degree from
+// which the parallel scan wins at every larger size tested; the grain is
+// half of it, so no chunk is cheaper than the task that runs it.
+inline ParallelRelaxTuning calibrate_parallel_relax()
+{
+    ParallelRelaxTuning tuning;
+    tuning.origin = "calibrated";
+    tuning.threshold = PARALLEL_RELAX_OFF;
+    tuning.grain = 1;
+    if (parallel_relax_threads() < 2)
+        return tuning;
+
+    const std::size_t N = std::size_t(1) << 20;
+    const std::size_t MIN_DEGREE = 64, MAX_DEGREE = std::size_t(1) << 16;
+    const int REPS = 31;
+
+    std::mt19937 rng(12345);
+    std::vector<long long> dist(N, 0);
+    std::vector<int> targets(MAX_DEGREE), weights(MAX_DEGREE);
+    for (std::size_t i = 0; i < MAX_DEGREE; ++i)
+    {
+        targets[i] = (int)(rng() % N);
+        weights[i] = (int)(rng() % 1000);
+    }
+    std::vector<std::uint32_t> out(MAX_DEGREE);
+    // Scan results are summed per thread, so the timed work has a use and
+    // threads share nothing; the total is published once at the end.
+    struct Lane
+    {
+        std::vector<std::uint32_t> idx;
+        std::size_t sink = 0;
+    };
+    tbb::enumerable_thread_specific<Lane> lanes;
+    std::size_t sink = 0;
+
+    // Median over REPS runs, each repeating the scan to cover ~64k arcs.
+    auto time_ns = [&](std::size_t degree, auto &&scan)
+    {
+        std::size_t inner = std::max<std::size_t>(1, MAX_DEGREE / degree);
+        std::vector<double> samples(REPS);
+        for (int r = 0; r < REPS; ++r)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (std::size_t k = 0; k < inner; ++k)
+                scan(degree);
+            samples[r] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / inner;
+        }
+        std::nth_element(samples.begin(), samples.begin() + REPS / 2, samples.end());
+        return samples[REPS / 2];
+    };
+    auto serial = [&](std::size_t degree)
+    { sink += find_improving(targets.data(), weights.data(), degree, 1, dist.data(), out.data()); };
+
+    std::vector<std::size_t> degrees;
+    std::vector<bool> wins;
+    for (std::size_t degree = MIN_DEGREE; degree <= MAX_DEGREE; degree *= 2)
+    {
+        std::size_t grain = std::max<std::size_t>(degree / 2, 1);
+        auto parallel = [&](std::size_t deg)
+        {
+            tbb::parallel_for(tbb::blocked_range<std::size_t>(0, deg, grain), [&](const auto &r)
+                              {
+                auto &lane = lanes.local();
+                lane.idx.resize(r.size());
+                lane.sink += find_improving(targets.data() + r.begin(), weights.data() + r.begin(), r.size(), 1,
+                                            dist.data(), lane.idx.data()); });
+        };
+        degrees.push_back(degree);
+        wins.push_back(time_ns(degree, parallel) < time_ns(degree, serial));
+    }
+
+    for (auto &lane : lanes)
+        sink += lane.sink;
+    volatile std::size_t keep = sink;
+    (void)keep;
+
+    for (std::size_t i = degrees.size(); i-- > 0 && wins[i];)
+        tuning.threshold = degrees[i];
+    if (!tuning.serial_only())
+        tuning.grain = tuning.threshold / 2;
+    return tuning;
+}
+
+// Loads the tuning for this machine from the cache, calibrating and saving
+// it on a miss or when recalibrate is set.
+inline ParallelRelaxTuning tune_parallel_relax(bool recalibrate = false)
+{
+    std::string path = parallel_relax_cache_path();
+    std::string key = parallel_relax_key();
+    ParallelRelaxTuning tuning;
+    if (!recalibrate && !path.empty() && load_parallel_relax_tuning(path, key, tuning))
+        return tuning;
+    tuning = calibrate_parallel_relax();
+    if (!path.empty())
+        save_parallel_relax_tuning(path, key, tuning);
+    return tuning;
+}
+
+inline std::string describe(const ParallelRelaxTuning &tuning)
+{
+    if (tuning.serial_only())
+        return "off (serial relaxation, " + tuning.origin + ")";
+    return std::to_string(tuning.threshold) + " arcs (grain " + std::to_string(tuning.grain) + ", " + tuning.origin +
+           ")";
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+
+#include "dimacs.hpp"
+#include "graph.hpp"
+
+// A renumbering of the nodes 1..n. new_id[old] and old_id[new] are inverse
+// permutations; slot 0 maps to itself.
+struct NodeOrder
+{
+    std::vector<int> new_id;
+    std::vector<int> old_id;
+
+    bool empty() const { return new_id.empty(); }
+    int to_new(int v) const { return empty() ? v : new_id[v]; }
+    int to_old(int v) const { return empty() ? v : old_id[v]; }
+};
+
+enum class ReorderKind
+{
+    None,
+    Bfs,
+    Hilbert,
+};
+
+inline bool parse_reorder_kind(const std::string &name, ReorderKind &kind)
+{
+    if (name == "none")
+        kind = ReorderKind::None;
+    else if (name == "bfs")
+        kind = ReorderKind::Bfs;
+    else if (name == "hilbert")
+        kind = ReorderKind::Hilbert;
+    else
+        return false;
+    return true;
+}
+
+inline const char *reorder_kind_name(ReorderKind kind)
+{
+    switch (kind)
+    {
+    case ReorderKind::None:
+        return "none";
+    case ReorderKind::Bfs:
+        return "bfs";
+    case ReorderKind::Hilbert:
+        return "hilbert";
+    }
+    return "?";
+}
+
+inline NodeOrder order_from_sequence(std::vector<int> old_id)
+{
+    NodeOrder order;
+    order.old_id = std::move(old_id);
+    order.new_id.assign(order.old_id.size(), 0);
+    for (std::size_t i = 0; i < order.old_id.size(); ++i)
+        order.new_id[order.old_id[i]] = (int)i;
+    return order;
+}
+
+// Cuthill-McKee: breadth-first numbering over out-arcs, visiting the
+// neighbours of each node in increasing degree and starting every new
+// component at its lowest-degree unvisited node. Nodes close in the BFS get
+// close ids, so a search's frontier touches few cache lines.
+inline NodeOrder bfs_order(const CsrGraph &graph)
+{
+    const int n = graph.num_nodes();
+    std::vector<int> by_degree(n);
+    for (int v = 1; v <= n; ++v)
+        by_degree[v - 1] = v;
+    tbb::parallel_sort(by_degree.begin(), by_degree.end(), [&](int a, int b)
+                       { return graph.degree(a) < graph.degree(b) || (graph.degree(a) == graph.degree(b) && a < b); });
+
+    std::vector<int> sequence;
+    sequence.reserve(n + 1);
+    sequence.push_back(0);
+    std::vector<char> visited(n + 1, 0);
+    std::vector<int> neighbours;
+    for (int start : by_degree)
+    {
+        if (visited[start])
+            continue;
+        visited[start] = 1;
+        std::size_t head = sequence.size();
+        sequence.push_back(start);
+        for (; head < sequence.size(); ++head)
+        {
+            neighbours.clear();
+            for (int v : graph.targets(sequence[head]))
+            {
+                if (!visited[v])
+                {
+                    visited[v] = 1;
+                    neighbours.push_back(v);
+                }
+            }
+            std::sort(neighbours.begin(), neighbours.end(), [&](int a, int b)
+                      { return graph.degree(a) < graph.degree(b); });
+            sequence.insert(sequence.end(), neighbours.begin(), neighbours.end());
+        }
+    }
+    return order_from_sequence(std::move(sequence));
+}
+
+// Position of (x, y) on a Hilbert curve over a 2^16 x 2^16 grid.
+inline std::uint64_t hilbert_index(std::uint32_t x, std::uint32_t y)
+{
+    std::uint64_t d = 0;
+    for (std::uint32_t s = 1u << 15; s > 0; s >>= 1)
+    {
+        std::uint32_t rx = (x & s) ? 1 : 0;
+        std::uint32_t ry = (y & s) ? 1 : 0;
+        d += (std::uint64_t)s * s * ((3 * rx) ^ ry);
+        if (ry == 0)
+        {
+            if (rx == 1)
+            {
+                x = 0xffff - x;
+                y = 0xffff - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+// Sorts nodes along a Hilbert curve through their coordinates, so nodes
+// that are near in the plane (and hence in a road network) get near ids.
+inline NodeOrder hilbert_order(const std::vector<Coord> &coords)
+{
+    const int n = (int)coords.size() - 1;
+    long long min_x = 0, min_y = 0, max_x = 0, max_y = 0;
+    if (n > 0)
+    {
+        min_x = max_x = coords[1].x;
+        min_y = max_y = coords[1].y;
+    }
+    for (int v = 2; v <= n; ++v)
+    {
+        min_x = std::min<long long>(min_x, coords[v].x);
+        max_x = std::max<long long>(max_x, coords[v].x);
+        min_y = std::min<long long>(min_y, coords[v].y);
+        max_y = std::max<long long>(max_y, coords[v].y);
+    }
+    double scale = 65535.0 / std::max<long long>(1, std::max(max_x - min_x, max_y - min_y));
+
+    std::vector<std::pair<std::uint64_t, int>> keys(n);
+    tbb::parallel_for(1, n + 1, [&](int v)
+                      {
+        auto x = (std::uint32_t)((coords[v].x - min_x) * scale);
+        auto y = (std::uint32_t)((coords[v].y - min_y) * scale);
+        keys[v - 1] = {hilbert_index(x, y), v}; });
+    tbb::parallel_sort(keys.begin(), keys.end());
+
+    std::vector<int> sequence(n + 1, 0);
+    for (int i = 0; i < n; ++i)
+        sequence[i + 1] = keys[i].second;
+    return order_from_sequence(std::move(sequence));
+}
+
+// Renumbers graph by order; every adjacency keeps its arc order.
+inline CsrGraph permute_graph(const CsrGraph &graph, const NodeOrder &order)
+{
+    const int n = graph.num_nodes();
+    std::vector<std::uint64_t> offsets(n + 2, 0);
+    for (int v = 1; v <= n; ++v)
+        offsets[v + 1] = offsets[v] + graph.degree(order.old_id[v]);
+
+    std::vector<int> targets(graph.num_edges());
+    std::vector<int> weights(graph.num_edges());
+    tbb::parallel_for(1, n + 1, [&](int v)
+                      {
+        int old = order.old_id[v];
+        auto old_targets = graph.targets(old);
+        auto old_weights = graph.weights(old);
+        for (std::size_t i = 0; i < old_targets.size(); ++i)
+        {
+            targets[offsets[v] + i] = order.new_id[old_targets[i]];
+            weights[offsets[v] + i] = old_weights[i];
+        }});
+    return CsrGraph(std::move(offsets), std::move(targets), std::move(weights));
+}
+
+template <typename T>
+std::vector<T> permute_nodes(const std::vector<T> &values, const NodeOrder &order)
+{
+    std::vector<T> out(values.size());
+    for (std::size_t v = 0; v < values.size(); ++v)
+        out[v] = values[order.old_id[v]];
+    return out;
+}
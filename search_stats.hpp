@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+
+// Hot-path counters, compiled in with -DDIJKSTRA_STATS (CMake option
+// DIJKSTRA_STATS). Without it every update sits behind a false
+// `if constexpr` and the fields simply stay zero. The source tree cache
+// counters are per lookup, off the hot path, and always counted.
+#ifdef DIJKSTRA_STATS
+inline constexpr bool SEARCH_STATS_ENABLED = true;
+#else
+inline constexpr bool SEARCH_STATS_ENABLED = false;
+#endif
+
+struct SearchStats
+{
+    // Nodes whose arcs were expanded (delta-stepping: frontier entries).
+    std::uint64_t settled = 0;
+    // Queue entries dropped because the node had improved since (lazy
+    // queues), or bucket entries that had moved on (delta-stepping).
+    std::uint64_t stale_pops = 0;
+    std::uint64_t arcs_scanned = 0;
+    // Relaxations that lowered a label.
+    std::uint64_t improvements = 0;
+    // Largest queue size (delta-stepping: pending bucket entries).
+    std::uint64_t peak_queue = 0;
+    // Nodes relaxed through the parallel_for branch of dijkstra_parallel.
+    std::uint64_t parallel_nodes = 0;
+    // Candidates from that branch that no longer improved in the serial
+    // merge (duplicate targets, or beaten by another arc of the same node).
+    std::uint64_t merge_rejected = 0;
+    // Failed compare-and-swap rounds on dist in delta-stepping.
+    std::uint64_t cas_retries = 0;
+    // Delta-stepping light/heavy relaxation phases.
+    std::uint64_t phases = 0;
+    // Source tree cache (tree_cache.hpp) lookups, and trees it added and
+    // dropped.
+    std::uint64_t cache_hits = 0;
+    std::uint64_t cache_misses = 0;
+    std::uint64_t cache_inserts = 0;
+    std::uint64_t cache_evictions = 0;
+
+    double cache_hit_rate() const
+    {
+        return cache_hits + cache_misses ? (double)cache_hits / (cache_hits + cache_misses) : 0.0;
+    }
+
+    SearchStats &operator+=(const SearchStats &o)
+    {
+        settled += o.settled;
+        stale_pops += o.stale_pops;
+        arcs_scanned += o.arcs_scanned;
+        improvements += o.improvements;
+        peak_queue = peak_queue > o.peak_queue ? peak_queue : o.peak_queue;
+        parallel_nodes += o.parallel_nodes;
+        merge_rejected += o.merge_rejected;
+        cas_retries += o.cas_retries;
+        phases += o.phases;
+        cache_hits += o.cache_hits;
+        cache_misses += o.cache_misses;
+        cache_inserts += o.cache_inserts;
+        cache_evictions += o.cache_evictions;
+        return *this;
+    }
+};
+
+// Without DIJKSTRA_STATS, stats holding only cache lookups print just those.
+inline void print_search_stats(std::ostream &out, const char *label, const SearchStats &s)
+{
+    bool cache = s.cache_hits || s.cache_misses;
+    out << label << ":";
+    if (SEARCH_STATS_ENABLED || !cache)
+    {
+        out << " settled " << s.settled << ", stale pops " << s.stale_pops << ", arcs " << s.arcs_scanned
+            << ", improvements " << s.improvements << ", peak queue " << s.peak_queue;
+        if (s.parallel_nodes)
+            out << ", parallel nodes " << s.parallel_nodes << ", merge rejected " << s.merge_rejected;
+        if (s.phases)
+            out << ", phases " << s.phases << ", CAS retries " << s.cas_retries;
+        if (cache)
+            out << ",";
+    }
+    if (cache)
+        out << " cache hits " << s.cache_hits << ", misses " << s.cache_misses << " (" << s.cache_hit_rate() * 100.0
+            << "% hit rate), inserts " << s.cache_inserts << ", evictions " << s.cache_evictions;
+    out << "\n";
+}
@@ -0,0 +1,266 @@
+#pragma once
+
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+
+#include "ch.hpp"
+#include "dijkstra.hpp"
+#include "graph.hpp"
+#include "heaps.hpp"
+#include "tree_cache.hpp"
+
+// Line protocol of dijkstra_server. Every non-blank request line gets exactly
+// one reply line, in request order:
+//
+//   <s> <t>  | dist <s> <t>   ->  <s> <t> <distance|inf>
+//   path <s> <t>              ->  <s> <t> <distance|inf> <s> ... <t>
+//   stats                     ->  queries <n> errors <n> mean_us <x>
+//                                 [cache_hits <n> cache_misses <n> cache_trees <n> cache_mb <x>]
+//   quit                      ->  bye (the connection is closed)
+//
+// Malformed requests get "error <reason>".
+
+// Answers requests on a graph loaded once, with one reusable workspace per
+// TBB worker. With a contraction hierarchy, queries go through ch_query;
+// otherwise through a point-to-point dijkstra_sequential. With a tree cache,
+// sources it holds are answered from their cached tree.
+template <template <typename> class Queue>
+class QueryServer
+{
+public:
+    QueryServer(const CsrGraph &graph, const ContractionHierarchy *ch = nullptr, SourceTreeCache *cache = nullptr)
+        : graph_(graph), ch_(ch), cache_(cache), workspaces_([&graph]
+                                              { return QueryWorkspace<Queue>(graph); }),
+          ch_workspaces_([ch]
+                         { return ChQueryWorkspace(*ch); })
+    {
+    }
+
+    // Answers lines[i] into replies[i], concurrently.
+    void answer(const std::vector<std::string> &lines, std::vector<std::string> &replies)
+    {
+        replies.resize(lines.size());
+        tbb::parallel_for(std::size_t(0), lines.size(), [&](std::size_t i)
+                          { replies[i] = answer(lines[i]); });
+    }
+
+    std::string answer(const std::string &line)
+    {
+        std::istringstream in(line);
+        std::string command;
+        in >> command;
+        if (command == "stats")
+        {
+            std::uint64_t n = queries_.load(), ns = total_ns_.load();
+            std::ostringstream out;
+            out << "queries " << n << " errors " << errors_.load() << " mean_us " << (n ? ns / 1000.0 / n : 0.0);
+            if (cache_)
+            {
+                SearchStats c = cache_->stats();
+                out << " cache_hits " << c.cache_hits << " cache_misses " << c.cache_misses << " cache_trees "
+                    << cache_->trees() << " cache_mb " << cache_->bytes() / (1024.0 * 1024.0);
+            }
+            return out.str();
+        }
+
+        bool want_path = command == "path";
+        if (command != "dist" && !want_path)
+            in.seekg(0);
+
+        long long s, t;
+        std::string extra;
+        if (!(in >> s >> t) || (in >> extra))
+            return fail("expected [dist|path] <source> <target>");
+        if (s < 1 || s > graph_.num_nodes() || t < 1 || t > graph_.num_nodes())
+            return fail("node out of range");
+
+        auto start = std::chrono::steady_clock::now();
+        PathResult result = query((int)s, (int)t, want_path);
+        total_ns_ += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start)
+                         .count();
+        ++queries_;
+
+        std::string reply = std::to_string(s) + " " + std::to_string(t) + " ";
+        if (result.distance >= DIST_INF)
+            return reply + "inf";
+        reply += std::to_string(result.distance);
+        for (int v : result.path)
+            reply += " " + std::to_string(v);
+        return reply;
+    }
+
+    PathResult query(int source, int target, bool want_path)
+    {
+        PathResult result;
+        if (cache_ && cache_->lookup<Queue>(graph_, source, target, want_path, result))
+            return result;
+        if (ch_)
+        {
+            result = ch_query(*ch_, source, target, ch_workspaces_.local());
+            if (!want_path)
+                result.path.clear();
+            return result;
+        }
+        auto &ws = workspaces_.local();
+        dijkstra_sequential(graph_, source, ws, {&target, 1});
+        if (want_path)
+            return extract_path<long long>(ws.dist(), ws.parent(), target);
+        result.distance = ws.dist(target);
+        return result;
+    }
+
+private:
+    std::string fail(const char *reason)
+    {
+        ++errors_;
+        return std::string("error ") + reason;
+    }
+
+    const CsrGraph &graph_;
+    const ContractionHierarchy *ch_;
+    SourceTreeCache *cache_;
+    tbb::enumerable_thread_specific<QueryWorkspace<Queue>> workspaces_;
+    tbb::enumerable_thread_specific<ChQueryWorkspace> ch_workspaces_;
+    std::atomic<std::uint64_t> queries_{0};
+    std::atomic<std::uint64_t> errors_{0};
+    std::atomic<std::uint64_t> total_ns_{0};
+};
+
+// Buffered line I/O over a pair of file descriptors (stdin/stdout or a
+// socket). read_batch blocks for one complete line, then also takes every
+// further line already buffered, so pipelined clients get their requests
+// answered together while interactive ones see no added delay.
+class LineChannel
+{
+public:
+    LineChannel(int in_fd, int out_fd) : in_fd_(in_fd), out_fd_(out_fd) {}
+
+    // Returns false once the input is closed and no line is left. A final
+    // line without a newline still counts.
+    bool read_batch(std::vector<std::string> &lines, std::size_t max_lines = 4096)
+    {
+        lines.clear();
+        while (true)
+        {
+            take_lines(lines, max_lines);
+            if (!lines.empty())
+                return true;
+            if (eof_)
+            {
+                if (pos_ < buf_.size())
+                {
+                    lines.push_back(buf_.substr(pos_));
+                    pos_ = buf_.size();
+                    return true;
+                }
+                return false;
+            }
+            fill();
+        }
+    }
+
+    bool write_all(const std::string &data)
+    {
+        const char *p = data.data();
+        std::size_t left = data.size();
+        while (left > 0)
+        {
+            ssize_t n = ::write(out_fd_, p, left);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            p += n;
+            left -= n;
+        }
+        return true;
+    }
+
+private:
+    void take_lines(std::vector<std::string> &lines, std::size_t max_lines)
+    {
+        while (lines.size() < max_lines)
+        {
+            std::size_t nl = buf_.find('\n', pos_);
+            if (nl == std::string::npos)
+                break;
+            std::size_t end = nl > pos_ && buf_[nl - 1] == '\r' ? nl - 1 : nl;
+            lines.push_back(buf_.substr(pos_, end - pos_));
+            pos_ = nl + 1;
+        }
+        if (pos_ > 0 && pos_ == buf_.size())
+        {
+            buf_.clear();
+            pos_ = 0;
+        }
+    }
+
+    void fill()
+    {
+        if (pos_ > 0)
+        {
+            buf_.erase(0, pos_);
+            pos_ = 0;
+        }
+        char chunk[1 << 16];
+        ssize_t n;
+        do
+            n = ::read(in_fd_, chunk, sizeof chunk);
+        while (n < 0 && errno == EINTR);
+        if (n <= 0)
+            eof_ = true;
+        else
+            buf_.append(chunk, n);
+    }
+
+    int in_fd_;
+    int out_fd_;
+    std::string buf_;
+    std::size_t pos_ = 0;
+    bool eof_ = false;
+};
+
+// Serves one connection until it closes or sends quit.
+template <template <typename> class Queue>
+void serve_channel(QueryServer<Queue> &server, LineChannel &channel)
+{
+    std::vector<std::string> lines, requests, replies;
+    while (channel.read_batch(lines))
+    {
+        requests.clear();
+        bool quit = false;
+        for (auto &line : lines)
+        {
+            std::size_t first = line.find_first_not_of(" \t");
+            if (first == std::string::npos)
+                continue;
+            std::size_t last = line.find_last_not_of(" \t\r");
+            if (line.compare(first, last + 1 - first, "quit") == 0)
+            {
+                quit = true;
+                break;
+            }
+            requests.push_back(std::move(line));
+        }
+
+        server.answer(requests, replies);
+        std::string out;
+        for (const auto &reply : replies)
+            out += reply + "\n";
+        if (quit)
+            out += "bye\n";
+        if (!channel.write_all(out) || quit)
+            return;
+    }
+}
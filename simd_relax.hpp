@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define DIJKSTRA_HAVE_X86_SIMD 1
+#endif
+
+// Vectorized candidate scan for the relaxation loop. For the arcs of one
+// node with distance d, find_improving writes the indices i with
+// d + weights[i] < dist[targets[i]] to out and returns their count. The
+// scan only reads dist; callers apply the (few) improvements with the usual
+// scalar relax, which re-checks each one, so duplicate targets stay correct.
+// The AVX2 and AVX-512 versions gather 4 or 8 distances per step; the
+// instruction set is picked once at runtime from the CPU, and the
+// DIJKSTRA_SIMD environment variable (scalar, avx2, avx512) can force a
+// lower level for comparison.
+
+// Below this degree the scalar loop wins over the kernel call.
+inline constexpr std::size_t SIMD_RELAX_MIN_DEGREE = 16;
+
+enum class SimdLevel
+{
+    Scalar,
+    Avx2,
+    Avx512,
+};
+
+inline const char *simd_level_name(SimdLevel level)
+{
+    switch (level)
+    {
+    case SimdLevel::Scalar:
+        return "scalar";
+    case SimdLevel::Avx2:
+        return "avx2";
+    case SimdLevel::Avx512:
+        return "avx512";
+    }
+    return "?";
+}
+
+inline std::size_t find_improving_scalar(const int *targets, const int *weights, std::size_t count, long long d,
+                                         const long long *dist, std::uint32_t *out)
+{
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        out[n] = (std::uint32_t)i;
+        n += d + weights[i] < dist[targets[i]];
+    }
+    return n;
+}
+
+#ifdef DIJKSTRA_HAVE_X86_SIMD
+
+__attribute__((target("avx2"))) inline std::size_t find_improving_avx2(const int *targets, const int *weights,
+                                                                        std::size_t count, long long d,
+                                                                        const long long *dist, std::uint32_t *out)
+{
+    const __m256i base = _mm256_set1_epi64x(d);
+    std::size_t n = 0, i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i idx = _mm_loadu_si128((const __m128i *)(targets + i));
+        __m256i cur = _mm256_i32gather_epi64((const long long *)dist, idx, 8);
+        __m256i cand = _mm256_add_epi64(base, _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i *)(weights + i))));
+        unsigned mask = (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(cur, cand)));
+        while (mask)
+        {
+            out[n++] = (std::uint32_t)(i + __builtin_ctz(mask));
+            mask &= mask - 1;
+        }
+    }
+    for (; i < count; ++i)
+        if (d + weights[i] < dist[targets[i]])
+            out[n++] = (std::uint32_t)i;
+    return n;
+}
+
+__attribute__((target("avx512f"))) inline std::size_t find_improving_avx512(const int *targets, const int *weights,
+                                                                             std::size_t count, long long d,
+                                                                             const long long *dist, std::uint32_t *out)
+{
+    const __m512i base = _mm512_set1_epi64(d);
+    std::size_t n = 0, i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        // The masked forms with a zero source keep GCC from flagging the
+        // unmasked intrinsics' undefined source as -Wmaybe-uninitialized.
+        __m256i idx = _mm256_loadu_si256((const __m256i *)(targets + i));
+        __m512i cur = _mm512_mask_i32gather_epi64(_mm512_setzero_si512(), 0xFF, idx, (const void *)dist, 8);
+        __m512i cand =
+            _mm512_add_epi64(base, _mm512_maskz_cvtepi32_epi64(0xFF, _mm256_loadu_si256((const __m256i *)(weights + i))));
+        unsigned mask = _mm512_cmplt_epi64_mask(cand, cur);
+        while (mask)
+        {
+            out[n++] = (std::uint32_t)(i + __builtin_ctz(mask));
+            mask &= mask - 1;
+        }
+    }
+    for (; i < count; ++i)
+        if (d + weights[i] < dist[targets[i]])
+            out[n++] = (std::uint32_t)i;
+    return n;
+}
+
+#endif
+
+inline SimdLevel detect_simd_level()
+{
+    SimdLevel best = SimdLevel::Scalar;
+#ifdef DIJKSTRA_HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        best = SimdLevel::Avx512;
+    else if (__builtin_cpu_supports("avx2"))
+        best = SimdLevel::Avx2;
+#endif
+    if (const char *env = std::getenv("DIJKSTRA_SIMD"))
+    {
+        SimdLevel forced = best;
+        if (std::strcmp(env, "scalar") == 0)
+            forced = SimdLevel::Scalar;
+        else if (std::strcmp(env, "avx2") == 0)
+            forced = SimdLevel::Avx2;
+        else if (std::strcmp(env, "avx512") == 0)
+            forced = SimdLevel::Avx512;
+        if (forced < best)
+            best = forced;
+    }
+    return best;
+}
+
+inline SimdLevel simd_level()
+{
+    static const SimdLevel level = detect_simd_level();
+    return level;
+}
+
+using FindImprovingFn = std::size_t (*)(const int *, const int *, std::size_t, long long, const long long *,
+                                        std::uint32_t *);
+
+inline FindImprovingFn find_improving_kernel()
+{
+    static const FindImprovingFn kernel = []() -> FindImprovingFn
+    {
+        switch (simd_level())
+        {
+#ifdef DIJKSTRA_HAVE_X86_SIMD
+        case SimdLevel::Avx512:
+            return find_improving_avx512;
+        case SimdLevel::Avx2:
+            return find_improving_avx2;
+#endif
+        default:
+            return find_improving_scalar;
+        }
+    }();
+    return kernel;
+}
+
+inline std::size_t find_improving(const int *targets, const int *weights, std::size_t count, long long d,
+                                  const long long *dist, std::uint32_t *out)
+{
+    return find_improving_kernel()(targets, weights, count, d, dist, out);
+}
@@ -0,0 +1,23 @@
+# Runs the same --batch query file through two programs and requires
+# identical results on stdout. Run with -DREFERENCE=... -DCANDIDATE=...
+# -DGRAPH=... -DPAIRS=... and optionally -DENGINE=... for the candidate.
+function(run_batch program out)
+    execute_process(COMMAND ${program} --no-cache ${ARGN} --batch ${PAIRS} ${GRAPH}
+                    OUTPUT_VARIABLE result
+                    ERROR_VARIABLE log
+                    RESULT_VARIABLE rc)
+    if(NOT rc EQUAL 0)
+        message(FATAL_ERROR "${program} exited with ${rc}\n${log}")
+    endif()
+    set(${out} "${result}" PARENT_SCOPE)
+endfunction()
+
+set(engine)
+if(DEFINED ENGINE)
+    set(engine --engine ${ENGINE})
+endif()
+run_batch(${REFERENCE} expected)
+run_batch(${CANDIDATE} actual ${engine})
+if(NOT actual STREQUAL expected)
+    message(FATAL_ERROR "Batch results differ\nexpected:\n${expected}\ngot:\n${actual}")
+endif()
@@ -0,0 +1,60 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ch.hpp"
+#include "dijkstra.hpp"
+#include "graph_cache.hpp"
+#include "heaps.hpp"
+#include "matrix.hpp"
+
+// Compares distance_matrix and ch_distance_matrix against one full
+// sequential search per source. The node lists repeat entries and share
+// nodes between sources and targets, as real depot/customer lists do.
+int check_matrix(const char *label, const DistanceMatrix &m, const std::vector<DijkstraResult> &trees)
+{
+    int bad = 0;
+    for (std::size_t i = 0; i < m.sources.size(); ++i)
+        for (std::size_t j = 0; j < m.targets.size(); ++j)
+            bad += m.at(i, j) != trees[i].dist[m.targets[j]];
+    if (bad)
+        std::cerr << label << ": " << bad << " of " << m.dist.size() << " entries differ\n";
+    return bad;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <graph.gr> <hierarchy.ch>\n";
+        return 1;
+    }
+    CsrGraph graph;
+    int n = 0;
+    if (!load_graph(argv[1], graph, n, nullptr, false))
+        return 1;
+    ContractionHierarchy ch;
+    load_contraction_hierarchy(argv[1], graph, argv[2], ch, std::cerr);
+
+    std::vector<int> sources, targets;
+    for (int v = 1; v <= n; v += std::max(1, n / 20))
+        sources.push_back(v);
+    for (int v = n; v >= 1; v -= std::max(1, n / 30))
+        targets.push_back(v);
+    sources.push_back(sources.front());
+    targets.push_back(sources.front());
+    targets.push_back(targets.front());
+
+    std::vector<DijkstraResult> trees;
+    for (int s : sources)
+        trees.push_back(dijkstra_sequential<LazyBinaryHeap>(graph, s));
+
+    int bad = 0;
+    for (QueueKind kind : {QueueKind::Dary, QueueKind::Radix})
+        bad += with_queue(kind, [&]<template <typename> class Q>()
+                          { return check_matrix(queue_kind_name(kind), distance_matrix<Q>(graph, sources, targets),
+                                                trees); });
+    bad += check_matrix("contraction hierarchy", ch_distance_matrix(ch, sources, targets), trees);
+    return bad ? 1 : 0;
+}
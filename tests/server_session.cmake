@@ -0,0 +1,30 @@
+# Feeds tests/server_requests.txt to dijkstra_server on stdin and checks the
+# replies: one per non-blank line in order, "bye" for quit and nothing for
+# the line after it. Run with -DSERVER=... -DGRAPH=... -DREQUESTS=... and
+# optionally -DCH_FILE=... to answer through a contraction hierarchy.
+set(args --no-cache)
+if(DEFINED CH_FILE)
+    list(APPEND args --ch-file ${CH_FILE})
+endif()
+execute_process(COMMAND ${SERVER} ${args} ${GRAPH}
+                INPUT_FILE ${REQUESTS}
+                OUTPUT_VARIABLE replies
+                ERROR_VARIABLE log
+                RESULT_VARIABLE rc)
+if(NOT rc EQUAL 0)
+    message(FATAL_ERROR "dijkstra_server exited with ${rc}\n${log}")
+endif()
+
+# stats is answered alongside the other lines of its batch, so its counts
+# are not fixed.
+string(CONCAT expected
+       "^1 11 22\n"
+       "1 12 inf\n"
+       "8 10 5 8 9 10\n"
+       "error expected \\[dist\\|path\\] <source> <target>\n"
+       "error node out of range\n"
+       "queries [0-9]+ errors [0-9]+ mean_us [0-9.e+-]+\n"
+       "bye\n$")
+if(NOT replies MATCHES "${expected}")
+    message(FATAL_ERROR "Unexpected replies:\n${replies}")
+endif()
@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "dijkstra.hpp"
+#include "simd_relax.hpp"
+
+// Runs every find_improving kernel the CPU supports against the scalar one
+// at degrees around the 4- and 8-lane steps and SIMD_RELAX_MIN_DEGREE. The
+// inputs mix repeated targets, zero weights, ties (d + w == dist, which must
+// not count) and unreached nodes.
+int main()
+{
+    struct Kernel
+    {
+        const char *name;
+        FindImprovingFn fn;
+    };
+    std::vector<Kernel> kernels;
+#ifdef DIJKSTRA_HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        kernels.push_back({"avx2", find_improving_avx2});
+    if (__builtin_cpu_supports("avx512f"))
+        kernels.push_back({"avx512", find_improving_avx512});
+#endif
+    if (kernels.empty())
+    {
+        std::cout << "No SIMD kernel on this CPU; nothing to compare\n";
+        return 0;
+    }
+
+    const int n = 64;
+    std::mt19937 rng(7);
+    std::vector<long long> dist(n + 1);
+    std::vector<int> targets, weights;
+    std::vector<std::uint32_t> expected, got;
+    int failures = 0;
+    for (std::size_t degree : {0, 1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 100})
+    {
+        for (int round = 0; round < 200; ++round)
+        {
+            const long long d = rng() % 50;
+            for (auto &x : dist)
+                x = rng() % 8 == 0 ? DIST_INF : (long long)(rng() % 120);
+            targets.resize(degree);
+            weights.resize(degree);
+            for (std::size_t i = 0; i < degree; ++i)
+            {
+                targets[i] = 1 + (int)(rng() % n);
+                bool tie = rng() % 4 == 0 && dist[targets[i]] != DIST_INF;
+                weights[i] = tie ? (int)std::max<long long>(0, dist[targets[i]] - d) : (int)(rng() % 60);
+            }
+            expected.assign(degree, 0);
+            std::size_t count = find_improving_scalar(targets.data(), weights.data(), degree, d, dist.data(),
+                                                      expected.data());
+            for (const auto &k : kernels)
+            {
+                got.assign(degree, 0);
+                std::size_t found = k.fn(targets.data(), weights.data(), degree, d, dist.data(), got.data());
+                if (found != count || !std::equal(got.begin(), got.begin() + found, expected.begin()))
+                {
+                    std::cerr << k.name << " differs from scalar at degree " << degree << " (" << found << " vs "
+                              << count << " improving arcs)\n";
+                    ++failures;
+                }
+            }
+        }
+    }
+    for (const auto &k : kernels)
+        std::cout << "Checked " << k.name << " against scalar\n";
+    return failures ? 1 : 0;
+}
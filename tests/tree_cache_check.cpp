@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <tbb/parallel_for.h>
+
+#include "dijkstra.hpp"
+#include "graph_cache.hpp"
+#include "heaps.hpp"
+#include "tree_cache.hpp"
+#include "validate.hpp"
+
+// Sends a skewed query stream (most queries from a few hot sources) through
+// one SourceTreeCache from all TBB workers. Every cached answer must match
+// the sequential distance and, when a path is asked for, be a valid path.
+// The cache must get hits, stay within its budget, and decline sources whose
+// distances do not fit the 32-bit trees.
+int check_graph(const CsrGraph &graph, bool expect_hits)
+{
+    const int n = graph.num_nodes();
+    const std::size_t tree_bytes = sizeof(SourceTree) + (n + 1) * 8;
+    SourceTreeCache cache(3 * tree_bytes);
+
+    std::mt19937 rng(11);
+    std::vector<int> sources(n);
+    for (int v = 1; v <= n; ++v)
+        sources[v - 1] = v;
+    std::vector<DijkstraResult> trees;
+    for (int s : sources)
+        trees.push_back(dijkstra_sequential<LazyBinaryHeap>(graph, s));
+
+    struct Query
+    {
+        int source, target;
+    };
+    std::vector<Query> queries(4000);
+    const int hot = std::min(n, 4);
+    for (auto &q : queries)
+    {
+        q.source = rng() % 10 < 8 ? 1 + (int)(rng() % hot) : 1 + (int)(rng() % n);
+        q.target = 1 + (int)(rng() % n);
+    }
+
+    std::atomic<int> bad{0};
+    tbb::parallel_for(std::size_t(0), queries.size(), [&](std::size_t i)
+                      {
+        auto [s, t] = queries[i];
+        bool want_path = i % 2;
+        PathResult result;
+        if (!cache.lookup<QuaternaryHeap>(graph, s, t, want_path, result))
+            return;
+        long long expected = trees[s - 1].dist[t];
+        if (result.distance != expected || (want_path && !validate_path(graph, s, t, result, expected)))
+            ++bad; });
+
+    SearchStats st = cache.stats();
+    if (bad)
+        std::cerr << bad << " cached answers differ from the sequential search\n";
+    if (cache.bytes() > cache.budget())
+    {
+        std::cerr << "Cache holds " << cache.bytes() << " bytes over a budget of " << cache.budget() << "\n";
+        ++bad;
+    }
+    if (expect_hits ? st.cache_hits == 0 || st.cache_inserts == 0 : cache.trees() != 0)
+    {
+        std::cerr << "Unexpected cache use: " << st.cache_hits << " hits, " << cache.trees() << " trees\n";
+        ++bad;
+    }
+    return bad;
+}
+
+// Usage: tree_cache_check <graph.gr>... [--wide <graph.gr>]; graphs after
+// --wide have distances past 32 bits and must never be cached.
+int main(int argc, char **argv)
+{
+    int failures = 0;
+    bool wide = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::string(argv[i]) == "--wide")
+        {
+            wide = true;
+            continue;
+        }
+        CsrGraph graph;
+        int n_nodes = 0;
+        if (!load_graph(argv[i], graph, n_nodes, nullptr, false))
+            return 1;
+        failures += check_graph(graph, !wide);
+    }
+    return failures ? 1 : 0;
+}
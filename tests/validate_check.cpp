@@ -0,0 +1,103 @@
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "dijkstra.hpp"
+#include "graph_cache.hpp"
+#include "heaps.hpp"
+#include "validate.hpp"
+
+// Feeds validate_tree and validate_path a correct answer and then one
+// injected fault at a time on tests/zero_cycle.gr. The correct tree must
+// pass; each fault must fail, with and without the reference distances.
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <zero_cycle.gr>\n";
+        return 1;
+    }
+    CsrGraph graph;
+    int n = 0;
+    if (!load_graph(argv[1], graph, n, nullptr, false))
+        return 1;
+    const int source = 1;
+    const DijkstraResult good = dijkstra_sequential<LazyBinaryHeap>(graph, source);
+
+    int failures = 0;
+    auto expect = [&](const std::string &what, bool ok, bool want_ok)
+    {
+        if (ok != want_ok)
+        {
+            std::cerr << what << ": validation " << (ok ? "passed" : "failed") << ", expected otherwise\n";
+            ++failures;
+        }
+    };
+    auto tree_ok = [&](const DijkstraResult &r, bool with_reference, double fraction = 1.0)
+    { return validate_tree(graph, source, r, with_reference ? &good : nullptr, fraction).ok(); };
+
+    expect("correct tree", tree_ok(good, true), true);
+    expect("correct tree without reference", tree_ok(good, false), true);
+    expect("correct tree, sampled", tree_ok(good, true, 0.5), true);
+
+    // Each fault edits a copy of the correct tree.
+    struct Fault
+    {
+        const char *name;
+        std::function<void(DijkstraResult &)> apply;
+    };
+    const Fault faults[] = {
+        {"distance one too high", [](DijkstraResult &r) { r.dist[11] += 1; }},
+        {"distance one too low", [](DijkstraResult &r) { r.dist[8] -= 1; }},
+        {"source not at zero", [](DijkstraResult &r) { r.dist[1] = 1; }},
+        {"parent without a tight arc", [](DijkstraResult &r) { r.parent[9] = 2; }},
+        {"unreached node with a parent", [](DijkstraResult &r) { r.parent[12] = 1; }},
+        {"reached node marked unreached", [](DijkstraResult &r)
+         {
+             r.dist[11] = DIST_INF;
+             r.parent[11] = -1;
+         }},
+        // Tight zero-weight arcs whose parents only point at each other: every
+        // label is right, but the chain never reaches the source.
+        {"zero-weight parent cycle 6-7", [](DijkstraResult &r)
+         {
+             r.parent[6] = 7;
+             r.parent[7] = 6;
+         }},
+        {"zero-weight parent cycle 2-3-4", [](DijkstraResult &r)
+         {
+             r.parent[2] = 4;
+             r.parent[3] = 2;
+             r.parent[4] = 3;
+         }},
+    };
+    for (const auto &fault : faults)
+    {
+        DijkstraResult bad = good;
+        fault.apply(bad);
+        expect(fault.name, tree_ok(bad, true), false);
+        expect(std::string(fault.name) + " without reference", tree_ok(bad, false), false);
+    }
+
+    const int target = 11;
+    PathResult path = extract_path(good, target);
+    expect("correct path", validate_path(graph, source, target, path, good.dist[target]), true);
+    PathResult unreachable = extract_path(good, 12);
+    expect("unreachable target", validate_path(graph, source, 12, unreachable, DIST_INF), true);
+
+    PathResult wrong = path;
+    wrong.distance += 1;
+    expect("path with wrong distance", validate_path(graph, source, target, wrong, good.dist[target]), false);
+    wrong = path;
+    wrong.path.pop_back();
+    expect("path ending early", validate_path(graph, source, target, wrong, good.dist[target]), false);
+    wrong = path;
+    wrong.path.insert(wrong.path.begin() + 1, 12);
+    expect("path over a missing arc", validate_path(graph, source, target, wrong, good.dist[target]), false);
+    wrong = unreachable;
+    wrong.distance = 5;
+    expect("unreachable target with a distance", validate_path(graph, source, 12, wrong, DIST_INF), false);
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <iostream>
+#include <span>
+
+#include "dijkstra.hpp"
+#include "graph_cache.hpp"
+#include "heaps.hpp"
+#include "relax_tuning.hpp"
+#include "validate.hpp"
+
+// One QueryWorkspace per queue serves interleaved early-exit, full and
+// parallel searches from many sources. Each answer must match a search in a
+// fresh workspace with the binary heap, so no label, parent or queue entry
+// may survive from one query into the next.
+int check_graph(const CsrGraph &graph)
+{
+    const int n = graph.num_nodes();
+    int failures = 0;
+    for (QueueKind kind : {QueueKind::Binary, QueueKind::Dary, QueueKind::Pairing, QueueKind::Radix, QueueKind::Dial})
+    {
+        int bad = with_queue(kind, [&]<template <typename> class Q>()
+                             {
+            QueryWorkspace<Q> ws(graph);
+            int mismatches = 0;
+            auto same_tree = [&](int source, const DijkstraResult &fresh)
+            {
+                return std::ranges::equal(ws.dist(), fresh.dist) &&
+                       validate_tree<long long>(graph, source, ws.dist(), ws.parent()).ok();
+            };
+            for (int source = 1; source <= n; source += std::max(1, n / 40))
+            {
+                DijkstraResult fresh = dijkstra_sequential<LazyBinaryHeap>(graph, source);
+                int stop[] = {n + 1 - source};
+                dijkstra_sequential(graph, source, ws, std::span<const int>(stop));
+                mismatches += ws.dist(stop[0]) != fresh.dist[stop[0]];
+                dijkstra_sequential(graph, source, ws);
+                mismatches += !same_tree(source, fresh);
+                dijkstra_parallel(graph, source, ws, std::span<const int>(stop));
+                mismatches += ws.dist(stop[0]) != fresh.dist[stop[0]];
+                dijkstra_parallel(graph, source, ws);
+                mismatches += !same_tree(source, fresh);
+            }
+            return mismatches; });
+        if (bad)
+            std::cerr << queue_kind_name(kind) << ": " << bad << " mismatches after workspace reuse\n";
+        failures += bad;
+    }
+    return failures;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <graph.gr>...\n";
+        return 1;
+    }
+    // A low threshold sends most nodes through the parallel scan and merge
+    // buffers, which the workspace keeps between queries too.
+    parallel_relax_tuning() = {4, 2, "test"};
+    int failures = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        CsrGraph graph;
+        int n_nodes = 0;
+        if (!load_graph(argv[i], graph, n_nodes, nullptr, false))
+            return 1;
+        failures += check_graph(graph);
+    }
+    return failures ? 1 : 0;
+}
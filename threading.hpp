@@ -0,0 +1,187 @@
+#pragma once
+
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <tbb/blocked_range.h>
+#include <tbb/info.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+
+#include "graph.hpp"
+
+// Worker count: an explicit request, else $DIJKSTRA_THREADS, else every
+// hardware thread TBB sees.
+inline int resolve_thread_count(int requested)
+{
+    if (requested > 0)
+        return requested;
+    if (const char *env = std::getenv("DIJKSTRA_THREADS"))
+    {
+        int n = std::atoi(env);
+        if (n > 0)
+            return n;
+    }
+    return tbb::info::default_concurrency();
+}
+
+// How searches are placed on multi-socket machines. Pin gives every NUMA
+// node its own task_arena constrained to that node's cores and a replica of
+// the graph first-touched there; Interleave keeps one pool and spreads the
+// graph pages round-robin over all nodes.
+enum class NumaMode
+{
+    Off,
+    Pin,
+    Interleave,
+};
+
+inline bool parse_numa_mode(const std::string &name, NumaMode &mode)
+{
+    if (name == "off")
+        mode = NumaMode::Off;
+    else if (name == "pin")
+        mode = NumaMode::Pin;
+    else if (name == "interleave")
+        mode = NumaMode::Interleave;
+    else
+        return false;
+    return true;
+}
+
+inline const char *numa_mode_name(NumaMode mode)
+{
+    switch (mode)
+    {
+    case NumaMode::Off:
+        return "off";
+    case NumaMode::Pin:
+        return "pin";
+    case NumaMode::Interleave:
+        return "interleave";
+    }
+    return "?";
+}
+
+// NUMA node ids as reported by TBB (through hwloc); empty when the topology
+// is unknown.
+inline std::vector<int> numa_node_ids()
+{
+    std::vector<int> ids;
+    for (auto id : tbb::info::numa_nodes())
+        if (id >= 0)
+            ids.push_back(id);
+    return ids;
+}
+
+// Asks the kernel to spread the pages of [data, data + bytes) round-robin
+// over nodes, migrating pages already faulted in. Returns false if the
+// range could not be rebound (e.g. no NUMA support in the kernel).
+inline bool interleave_pages(const void *data, std::size_t bytes, const std::vector<int> &nodes)
+{
+    if (bytes == 0 || nodes.empty())
+        return true;
+    const std::size_t BITS = 8 * sizeof(unsigned long);
+    int max_node = *std::max_element(nodes.begin(), nodes.end());
+    std::vector<unsigned long> mask(max_node / BITS + 1, 0);
+    for (int id : nodes)
+        mask[id / BITS] |= 1ul << (id % BITS);
+
+    const std::uintptr_t page = (std::uintptr_t)sysconf(_SC_PAGESIZE);
+    std::uintptr_t begin = (std::uintptr_t)data / page * page;
+    std::uintptr_t end = ((std::uintptr_t)data + bytes + page - 1) / page * page;
+    return syscall(SYS_mbind, begin, end - begin, MPOL_INTERLEAVE, mask.data(), mask.size() * BITS + 1,
+                   MPOL_MF_MOVE) == 0;
+}
+
+inline bool interleave_graph(const CsrGraph &graph, const std::vector<int> &nodes)
+{
+    auto bytes = [](auto span) { return span.size() * sizeof(span[0]); };
+    return interleave_pages(graph.offsets().data(), bytes(graph.offsets()), nodes) &&
+           interleave_pages(graph.all_targets().data(), bytes(graph.all_targets()), nodes) &&
+           interleave_pages(graph.all_weights().data(), bytes(graph.all_weights()), nodes);
+}
+
+// A private copy of the graph arrays. Run inside a NUMA-constrained arena,
+// the pages are first touched, and so placed, on that arena's node.
+inline CsrGraph replicate_graph(const CsrGraph &graph)
+{
+    auto copy = [](auto src)
+    {
+        std::vector<std::remove_const_t<typename decltype(src)::element_type>> dst(src.size());
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, src.size(), std::size_t(1) << 16),
+                          [&](const auto &r)
+                          { std::copy(src.begin() + r.begin(), src.begin() + r.end(), dst.begin() + r.begin()); });
+        return dst;
+    };
+    return {copy(graph.offsets()), copy(graph.all_targets()), copy(graph.all_weights())};
+}
+
+// One share of the worker pool: an arena plus the graph its searches read.
+struct ExecutionDomain
+{
+    int numa_node = -1;
+    int threads = 0;
+    std::unique_ptr<tbb::task_arena> arena;
+    CsrGraph graph;
+};
+
+// Builds the domains for mode. Off and Interleave yield a single domain
+// over all threads sharing graph; Pin splits the threads over the NUMA nodes
+// in proportion to their cores and replicates the graph into each. Machines
+// with one node always get a single domain.
+inline std::vector<ExecutionDomain> make_execution_domains(const CsrGraph &graph, int threads, NumaMode mode)
+{
+    std::vector<ExecutionDomain> domains;
+    std::vector<int> nodes = numa_node_ids();
+    if (mode != NumaMode::Pin || nodes.size() < 2)
+    {
+        auto &d = domains.emplace_back();
+        d.threads = threads;
+        d.arena = std::make_unique<tbb::task_arena>(threads);
+        d.graph = graph;
+        return domains;
+    }
+
+    int cores = 0;
+    for (int id : nodes)
+        cores += tbb::info::default_concurrency(id);
+    int assigned = 0;
+    for (std::size_t i = 0; i < nodes.size(); ++i)
+    {
+        int share = i + 1 == nodes.size() ? threads - assigned
+                                          : std::max(1, threads * tbb::info::default_concurrency(nodes[i]) / cores);
+        if (share <= 0)
+            break;
+        assigned += share;
+
+        auto &d = domains.emplace_back();
+        d.numa_node = nodes[i];
+        d.threads = share;
+        d.arena = std::make_unique<tbb::task_arena>(tbb::task_arena::constraints(nodes[i], share));
+        d.arena->execute([&]
+                         { d.graph = replicate_graph(graph); });
+    }
+    return domains;
+}
+
+inline std::string describe(const std::vector<ExecutionDomain> &domains)
+{
+    if (domains.size() == 1 && domains[0].numa_node < 0)
+        return std::to_string(domains[0].threads) + " threads";
+    std::string out;
+    for (const auto &d : domains)
+        out += (out.empty() ? "" : ", ") + std::string("node ") + std::to_string(d.numa_node) + ": " +
+               std::to_string(d.threads) + " threads";
+    return out;
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "dijkstra.hpp"
+#include "graph.hpp"
+#include "heaps.hpp"
+#include "search_stats.hpp"
+
+// A complete shortest-path tree from one source with 32-bit labels, 8 bytes
+// per node.
+struct SourceTree
+{
+    int source = 0;
+    std::vector<std::uint32_t> dist;
+    std::vector<int> parent;
+
+    std::size_t bytes() const
+    {
+        return sizeof(SourceTree) + dist.size() * sizeof(dist[0]) + parent.size() * sizeof(parent[0]);
+    }
+
+    PathResult path_to(int target, bool want_path) const
+    {
+        if (want_path)
+            return extract_path<std::uint32_t>(dist, parent, target);
+        PathResult result;
+        if (dist[target] != DistTraits<std::uint32_t>::inf)
+            result.distance = dist[target];
+        return result;
+    }
+};
+
+// Builds the tree from source, or returns null when some distance does not
+// fit in 32 bits (such sources are simply never cached). The search counters
+// are added to stats when given.
+template <template <typename> class Queue>
+std::shared_ptr<const SourceTree> build_source_tree(const CsrGraph &graph, int source, SearchStats *stats = nullptr)
+{
+    auto result = dijkstra_sequential<std::uint32_t, Queue>(graph, source);
+    if (stats)
+        *stats += result.stats;
+    if (result.overflow)
+        return nullptr;
+    auto tree = std::make_shared<SourceTree>();
+    tree->source = source;
+    tree->dist = std::move(result.dist);
+    tree->parent = std::move(result.parent);
+    return tree;
+}
+
+// LRU cache of source trees under a memory budget, safe to share between
+// threads. Admission follows TinyLFU: recent lookups are counted per source
+// (counts are halved periodically), a tree is only built for a source seen
+// at least twice, and when the cache is full only if that source is more
+// popular than the LRU victim it would evict. One-off sources keep using
+// point-to-point searches and cannot flush the hot ones.
+class SourceTreeCache
+{
+public:
+    explicit SourceTreeCache(std::size_t budget_bytes) : budget_(budget_bytes) {}
+
+    // The cached tree for source, marked most recently used; null on a miss.
+    std::shared_ptr<const SourceTree> find(int source)
+    {
+        std::lock_guard lock(mutex_);
+        count(source);
+        auto it = index_.find(source);
+        if (it == index_.end())
+        {
+            ++stats_.cache_misses;
+            return nullptr;
+        }
+        ++stats_.cache_hits;
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return *it->second;
+    }
+
+    // Whether a miss on source should build and insert its tree of the
+    // given size.
+    bool admit(int source, std::size_t tree_bytes)
+    {
+        std::lock_guard lock(mutex_);
+        if (uncacheable_.count(source) || tree_bytes > budget_)
+            return false;
+        std::uint32_t f = freq_[source];
+        if (f < 2)
+            return false;
+        return bytes_ + tree_bytes <= budget_ || lru_.empty() || f > freq_[lru_.back()->source];
+    }
+
+    void insert(std::shared_ptr<const SourceTree> tree)
+    {
+        if (!tree || tree->bytes() > budget_)
+            return;
+        std::lock_guard lock(mutex_);
+        if (index_.count(tree->source))
+            return;
+        bytes_ += tree->bytes();
+        lru_.push_front(tree);
+        index_[tree->source] = lru_.begin();
+        ++stats_.cache_inserts;
+        while (bytes_ > budget_)
+        {
+            bytes_ -= lru_.back()->bytes();
+            index_.erase(lru_.back()->source);
+            lru_.pop_back();
+            ++stats_.cache_evictions;
+        }
+    }
+
+    // Answers source -> target from the cache, building the tree when the
+    // source is admitted; returns false when the caller has to search.
+    template <template <typename> class Queue>
+    bool lookup(const CsrGraph &graph, int source, int target, bool want_path, PathResult &result)
+    {
+        auto tree = find(source);
+        if (!tree && admit(source, sizeof(SourceTree) + (graph.num_nodes() + 1) * 8))
+        {
+            SearchStats build;
+            tree = build_source_tree<Queue>(graph, source, &build);
+            {
+                std::lock_guard lock(mutex_);
+                stats_ += build;
+            }
+            if (tree)
+                insert(tree);
+            else
+            {
+                std::lock_guard lock(mutex_);
+                uncacheable_.insert(source);
+            }
+        }
+        if (!tree)
+            return false;
+        result = tree->path_to(target, want_path);
+        return true;
+    }
+
+    // Lookup counters, plus the search counters of the tree builds.
+    SearchStats stats() const
+    {
+        std::lock_guard lock(mutex_);
+        return stats_;
+    }
+
+    std::size_t trees() const
+    {
+        std::lock_guard lock(mutex_);
+        return index_.size();
+    }
+
+    std::size_t bytes() const
+    {
+        std::lock_guard lock(mutex_);
+        return bytes_;
+    }
+
+    std::size_t budget() const { return budget_; }
+
+private:
+    using Entry = std::shared_ptr<const SourceTree>;
+
+    // Counts a lookup; every 16 lookups per cacheable tree all counts are
+    // halved, so popularity follows the recent traffic.
+    void count(int source)
+    {
+        ++freq_[source];
+        std::size_t capacity = std::max<std::size_t>(64, 2 * index_.size());
+        if (++lookups_ < 16 * capacity)
+            return;
+        lookups_ = 0;
+        for (auto it = freq_.begin(); it != freq_.end();)
+        {
+            it->second /= 2;
+            it = it->second ? std::next(it) : freq_.erase(it);
+        }
+    }
+
+    std::size_t budget_;
+    std::size_t bytes_ = 0;
+    std::list<Entry> lru_;
+    std::unordered_map<int, std::list<Entry>::iterator> index_;
+    std::unordered_map<int, std::uint32_t> freq_;
+    std::size_t lookups_ = 0;
+    // Sources whose trees overflow 32-bit labels.
+    std::unordered_set<int> uncacheable_;
+    SearchStats stats_;
+    mutable std::mutex mutex_;
+};
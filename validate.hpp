@@ -0,0 +1,253 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_reduce.h>
+
+#include "dijkstra.hpp"
+#include "graph.hpp"
+
+// Checks on a shortest-path tree that need no trust in the engine that built
+// it. Per checked node v:
+//   - reference: dist[v] equals a reference search (when one is given);
+//   - tree: the source has distance 0 and no parent, unreached nodes have no
+//     parent, and every other node has a parent p with an arc p -> v of
+//     weight dist[v] - dist[p] and a parent chain that reaches the source
+//     (tight arcs alone allow a zero-weight cycle labelled too low);
+//   - arcs: no out-arc v -> w could still improve w (dist[w] <= dist[v] +
+//     weight).
+// Tree and arc checks over all nodes certify the distances on their own. A
+// sampled run without a reference does not: the chains it follows are not
+// checked for tight arcs beyond the sampled nodes.
+struct ValidationReport
+{
+    std::size_t checked = 0;
+    std::size_t reference_mismatches = 0;
+    std::size_t tree_errors = 0;
+    std::size_t arc_violations = 0;
+    // Lowest offending node ids, at most MAX_EXAMPLES.
+    std::vector<int> examples;
+
+    static constexpr std::size_t MAX_EXAMPLES = 5;
+
+    bool ok() const { return reference_mismatches == 0 && tree_errors == 0 && arc_violations == 0; }
+
+    void add_example(int v)
+    {
+        if (examples.size() < MAX_EXAMPLES)
+            examples.push_back(v);
+    }
+
+    void merge(const ValidationReport &o)
+    {
+        checked += o.checked;
+        reference_mismatches += o.reference_mismatches;
+        tree_errors += o.tree_errors;
+        arc_violations += o.arc_violations;
+        examples.insert(examples.end(), o.examples.begin(), o.examples.end());
+        std::sort(examples.begin(), examples.end());
+        examples.erase(std::unique(examples.begin(), examples.end()), examples.end());
+        if (examples.size() > MAX_EXAMPLES)
+            examples.resize(MAX_EXAMPLES);
+    }
+};
+
+// Deterministic node sample: keeps about fraction of the nodes, picked by a
+// hash of the id and seed so that different seeds cover different nodes.
+inline bool sampled_node(int v, double fraction, std::uint64_t seed)
+{
+    if (fraction >= 1.0)
+        return true;
+    std::uint64_t x = (std::uint64_t)v + seed * 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return (double)(x >> 11) < fraction * (double)(1ull << 53);
+}
+
+// Marks the nodes whose parent chain reaches source, walking up from the
+// nodes picked by sampled_node. Every node is walked at most once.
+inline std::vector<char> rooted_nodes(int n, int source, std::span<const int> parent, double fraction,
+                                      std::uint64_t seed)
+{
+    enum : char
+    {
+        Unknown,
+        Walking,
+        Rooted,
+        Unrooted
+    };
+    std::vector<char> state(n + 1, Unknown);
+    std::vector<int> chain;
+    for (int v = 1; v <= n; ++v)
+    {
+        if (state[v] != Unknown || !sampled_node(v, fraction, seed))
+            continue;
+        chain.clear();
+        char result;
+        for (int u = v;; u = parent[u])
+        {
+            if (u == source)
+                result = Rooted;
+            else if (u < 1 || u > n || state[u] == Walking)
+                result = Unrooted;
+            else if (state[u] != Unknown)
+                result = state[u];
+            else
+            {
+                state[u] = Walking;
+                chain.push_back(u);
+                continue;
+            }
+            break;
+        }
+        for (int u : chain)
+            state[u] = result;
+    }
+    for (char &s : state)
+        s = s == Rooted;
+    return state;
+}
+
+// Validates a complete tree (dist and parent) from source over the nodes
+// picked by sampled_node, in parallel. reference may be empty.
+template <typename Dist>
+ValidationReport validate_tree(const CsrGraph &graph, int source, std::span<const Dist> dist,
+                               std::span<const int> parent, std::span<const Dist> reference = {},
+                               double fraction = 1.0, std::uint64_t seed = 0)
+{
+    const long long inf = (long long)DistTraits<Dist>::inf;
+    std::vector<char> rooted = rooted_nodes(graph.num_nodes(), source, parent, fraction, seed);
+    auto check = [&](const tbb::blocked_range<int> &r, ValidationReport report)
+    {
+        for (int v = r.begin(); v < r.end(); ++v)
+        {
+            if (!sampled_node(v, fraction, seed))
+                continue;
+            ++report.checked;
+            long long dv = (long long)dist[v];
+            bool bad = false;
+
+            if (!reference.empty() && dist[v] != reference[v])
+            {
+                ++report.reference_mismatches;
+                bad = true;
+            }
+
+            bool tree_ok;
+            if (v == source)
+                tree_ok = dv == 0 && parent[v] == -1;
+            else if (dv >= inf)
+                tree_ok = parent[v] == -1;
+            else
+            {
+                int p = parent[v];
+                tree_ok = false;
+                if (p >= 1 && p <= graph.num_nodes() && (long long)dist[p] < inf)
+                {
+                    auto targets = graph.targets(p);
+                    auto weights = graph.weights(p);
+                    for (std::size_t i = 0; i < targets.size() && !tree_ok; ++i)
+                        tree_ok = targets[i] == v && (long long)dist[p] + weights[i] == dv;
+                }
+                tree_ok = tree_ok && rooted[v];
+            }
+            if (!tree_ok)
+            {
+                ++report.tree_errors;
+                bad = true;
+            }
+
+            if (dv < inf)
+            {
+                auto targets = graph.targets(v);
+                auto weights = graph.weights(v);
+                for (std::size_t i = 0; i < targets.size(); ++i)
+                {
+                    long long candidate = dv + weights[i];
+                    // Narrow labels cannot represent distances past their
+                    // range, so such arcs prove nothing.
+                    if (candidate < inf && (long long)dist[targets[i]] > candidate)
+                    {
+                        ++report.arc_violations;
+                        bad = true;
+                        break;
+                    }
+                }
+            }
+            if (bad)
+                report.add_example(v);
+        }
+        return report;
+    };
+
+    return tbb::parallel_reduce(tbb::blocked_range<int>(1, graph.num_nodes() + 1, 1024), ValidationReport{}, check,
+                                [](ValidationReport a, const ValidationReport &b)
+                                {
+                                    a.merge(b);
+                                    return a;
+                                });
+}
+
+template <typename Dist>
+ValidationReport validate_tree(const CsrGraph &graph, int source, const BasicDijkstraResult<Dist> &result,
+                               const std::type_identity_t<BasicDijkstraResult<Dist>> *reference = nullptr,
+                               double fraction = 1.0, std::uint64_t seed = 0)
+{
+    return validate_tree<Dist>(graph, source, result.dist, result.parent,
+                               reference ? std::span<const Dist>(reference->dist) : std::span<const Dist>(),
+                               fraction, seed);
+}
+
+// A point-to-point answer: the path runs from source to target over existing
+// arcs whose weights add up to the distance, which matches reference
+// (DIST_INF when unreachable). Parallel arcs count with their lightest weight.
+inline bool validate_path(const CsrGraph &graph, int source, int target, const PathResult &answer,
+                          long long reference)
+{
+    if (answer.distance != reference)
+        return false;
+    if (answer.distance >= DIST_INF || answer.path.empty())
+        return answer.path.empty();
+    if (answer.path.front() != source || answer.path.back() != target)
+        return false;
+    long long length = 0;
+    for (std::size_t i = 0; i + 1 < answer.path.size(); ++i)
+    {
+        int u = answer.path[i], v = answer.path[i + 1];
+        if (u < 1 || u > graph.num_nodes())
+            return false;
+        long long best = DIST_INF;
+        auto targets = graph.targets(u);
+        auto weights = graph.weights(u);
+        for (std::size_t j = 0; j < targets.size(); ++j)
+            if (targets[j] == v)
+                best = std::min<long long>(best, weights[j]);
+        if (best >= DIST_INF)
+            return false;
+        length += best;
+    }
+    return length == answer.distance;
+}
+
+inline void print_validation(std::ostream &out, const char *label, const ValidationReport &r, std::size_t n_nodes)
+{
+    out << label << ": " << r.checked << " of " << n_nodes << " nodes checked, " << r.reference_mismatches
+        << " reference mismatches, " << r.tree_errors << " tree errors, " << r.arc_violations << " arc violations -> "
+        << (r.ok() ? "OK" : "FAILED");
+    if (!r.examples.empty())
+    {
+        out << " (e.g. node";
+        for (int v : r.examples)
+            out << " " << v;
+        out << ")";
+    }
+    out << "\n";
+}